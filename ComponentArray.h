@@ -7,11 +7,25 @@
 #include <assert.h>
 #include <stdlib.h>
 
+// Capacity of every per-entity array. Override at build time (e.g. -DMAX_ENTITIES=200000)
+// for larger worlds; entity_manager.h must agree.
+#ifndef MAX_ENTITIES
 #define MAX_ENTITIES 10000
+#endif
 
 // Base "interface" for component arrays.
 typedef struct IComponentArray {
     void (*EntityDestroyed)(struct IComponentArray* self, uint32_t entity);
+    size_t (*GetSize)(const struct IComponentArray* self);
+    int (*IndexOf)(const struct IComponentArray* self, uint32_t entity);  /* -1 if absent */
+    void (*Swap)(struct IComponentArray* self, size_t indexA, size_t indexB);
+
+    // Metadata for telemetry, filled in by Init.
+    const char* name;          /* Component type name */
+    size_t componentSize;      /* sizeof one component */
+    size_t capacity;           /* Maximum number of components */
+    size_t bytesReserved;      /* sizeof the whole array, dense data plus maps */
+    size_t highWater;          /* Largest size seen since Init */
 } IComponentArray;
 
 // Macro to define a component array for any component type.
@@ -27,10 +41,49 @@ typedef struct IComponentArray {
     /* Forward declaration of the EntityDestroyed function */                                   \
     static inline void ComponentType##ComponentArray_EntityDestroyed(IComponentArray* base, uint32_t entity); \
                                                                                                 \
+    /* Number of valid components, through the base interface */                                \
+    static inline size_t ComponentType##ComponentArray_GetSize(const IComponentArray* base) {    \
+        return ((const ComponentType##ComponentArray*)base)->size;                                \
+    }                                                                                           \
+                                                                                                \
+    /* Dense index of an entity's component, -1 if it has none */                               \
+    static inline int ComponentType##ComponentArray_IndexOf(const IComponentArray* base,        \
+                                                            uint32_t entity) {                  \
+        return ((const ComponentType##ComponentArray*)base)->entityToIndexMap[entity];            \
+    }                                                                                           \
+                                                                                                \
+    /* Exchange two dense entries, keeping both maps consistent (used to reorder) */            \
+    static inline void ComponentType##ComponentArray_Swap(ComponentType##ComponentArray* arr,    \
+                                                          size_t indexA, size_t indexB) {       \
+        assert(indexA < arr->size && indexB < arr->size && "Index out of range.");               \
+        ComponentType component = arr->components[indexA];                                      \
+        arr->components[indexA] = arr->components[indexB];                                      \
+        arr->components[indexB] = component;                                                    \
+        uint32_t entityA = arr->indexToEntityMap[indexA];                                       \
+        uint32_t entityB = arr->indexToEntityMap[indexB];                                       \
+        arr->indexToEntityMap[indexA] = entityB;                                                \
+        arr->indexToEntityMap[indexB] = entityA;                                                \
+        arr->entityToIndexMap[entityB] = (int)indexA;                                           \
+        arr->entityToIndexMap[entityA] = (int)indexB;                                           \
+    }                                                                                           \
+                                                                                                \
+    static inline void ComponentType##ComponentArray_SwapBase(IComponentArray* base,             \
+                                                              size_t indexA, size_t indexB) {   \
+        ComponentType##ComponentArray_Swap((ComponentType##ComponentArray*)base, indexA, indexB); \
+    }                                                                                           \
+                                                                                                \
     /* Initialization function for a component array */                                         \
     static inline void ComponentType##ComponentArray_Init(ComponentType##ComponentArray* arr) {   \
         arr->base.EntityDestroyed = (void (*)(IComponentArray*, uint32_t))                       \
             ComponentType##ComponentArray_EntityDestroyed;                                      \
+        arr->base.GetSize = ComponentType##ComponentArray_GetSize;                              \
+        arr->base.IndexOf = ComponentType##ComponentArray_IndexOf;                              \
+        arr->base.Swap = ComponentType##ComponentArray_SwapBase;                                \
+        arr->base.name = #ComponentType;                                                        \
+        arr->base.componentSize = sizeof(ComponentType);                                        \
+        arr->base.capacity = MAX_ENTITIES;                                                      \
+        arr->base.bytesReserved = sizeof(ComponentType##ComponentArray);                        \
+        arr->base.highWater = 0;                                                                \
         arr->size = 0;                                                                          \
         for (int i = 0; i < MAX_ENTITIES; i++) {                                                \
             arr->entityToIndexMap[i] = -1;                                                      \
@@ -47,6 +100,9 @@ typedef struct IComponentArray {
         arr->indexToEntityMap[newIndex] = entity;                                               \
         arr->components[newIndex] = component;                                                  \
         arr->size++;                                                                            \
+        if (arr->size > arr->base.highWater) {                                                  \
+            arr->base.highWater = arr->size;                                                    \
+        }                                                                                       \
     }                                                                                           \
                                                                                                 \
     /* Remove a component from the array */                                                     \
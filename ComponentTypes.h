@@ -7,7 +7,22 @@ typedef enum {
     COMPONENT_TRANSFORM = 0,
     COMPONENT_RIGID_BODY,
     COMPONENT_GRAVITY,
+    COMPONENT_PARENT,
     COMPONENT_COUNT,
 } ComponentType;
 
+// Tag components are pure markers: a signature bit, and optionally a dense bitset
+// (see tags.h), but never a component array. They take the top signature bits so
+// component types can keep growing from the bottom.
+#define TAG_FIRST 24
+
+typedef enum {
+    TAG_STATIC = TAG_FIRST,   // Never moved by physics; other bodies still collide with it.
+    TAG_SELECTED,             // Picked by the user or a tool.
+    TAG_END,
+} TagType;
+
+#define TAG_COUNT (TAG_END - TAG_FIRST)
+#define TAG_INDEX(tag) ((int)(tag) - TAG_FIRST)
+
 #endif // COMPONENT_TYPES_H
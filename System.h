@@ -8,36 +8,61 @@
 
 #define MAX_SYSTEM_ENTITIES MAX_ENTITIES
 
-typedef struct {
+typedef struct ECS_System {
     Entity entities[MAX_SYSTEM_ENTITIES];
     int count;
+    int slot[MAX_ENTITIES];       // Index of each entity in entities, -1 if not a member.
     Signature requiredSignature;  // Bitmask representing required components.
+    Signature excludedSignature;  // Entities with any of these bits (e.g. tags) are left out.
+    uint32_t version;             // Bumped whenever the entity list changes.
+    const char* name;             // For telemetry and logs.
+    int highWater;                // Largest count seen.
+    // Optional: called when an entity leaves the system, while its components can
+    // still be read. NULL if the system keeps no per-entity state.
+    void (*onRemove)(struct ECS_System* sys, Entity entity);
 } ECS_System;
 
+// Empty system with no required or excluded signature and no removal hook.
+static inline void ECS_System_Init(ECS_System* sys, const char* name) {
+    sys->count = 0;
+    for (int i = 0; i < MAX_ENTITIES; i++) {
+        sys->slot[i] = -1;
+    }
+    sys->requiredSignature = 0;
+    sys->excludedSignature = 0;
+    sys->version = 0;
+    sys->name = name;
+    sys->highWater = 0;
+    sys->onRemove = NULL;
+}
+
 // Add an entity to the system (ensuring no duplicates).
 static inline void ECS_System_AddEntity(ECS_System* sys, Entity entity) {
-    for (int i = 0; i < sys->count; i++) {
-        if (sys->entities[i] == entity) {
-            return; // Already present.
-        }
+    if (sys->slot[entity] != -1) {
+        return; // Already present.
     }
     assert(sys->count < MAX_SYSTEM_ENTITIES && "System entity list is full.");
+    sys->slot[entity] = sys->count;
     sys->entities[sys->count++] = entity;
+    sys->version++;
+    if (sys->count > sys->highWater) {
+        sys->highWater = sys->count;
+    }
 }
 
-// Remove an entity from the system.
+// Remove an entity from the system. The last entity takes its place, so the list
+// order is not kept.
 static inline void ECS_System_RemoveEntity(ECS_System* sys, Entity entity) {
-    int i;
-    for (i = 0; i < sys->count; i++) {
-        if (sys->entities[i] == entity) {
-            break;
-        }
-    }
-    if (i < sys->count) {
-        for (; i < sys->count - 1; i++) {
-            sys->entities[i] = sys->entities[i + 1];
+    int i = sys->slot[entity];
+    if (i != -1) {
+        Entity last = sys->entities[--sys->count];
+        sys->entities[i] = last;
+        sys->slot[last] = i;
+        sys->slot[entity] = -1;
+        sys->version++;
+        if (sys->onRemove) {
+            sys->onRemove(sys, entity);
         }
-        sys->count--;
     }
 }
 
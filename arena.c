@@ -0,0 +1,139 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // MAP_ANONYMOUS, MAP_HUGETLB, MADV_HUGEPAGE
+#endif
+#include "arena.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#define ARENA_HUGE_PAGE_SIZE (2u * 1024u * 1024u)
+
+static size_t RoundUp(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+// Allocate the backing block. Large pages are tried first when requested; the
+// normal page path is used if they are unavailable.
+static uint8_t* AllocBlock(size_t size, int flags, int* hugePages) {
+    *hugePages = 0;
+#if defined(_WIN32)
+    if (flags & ARENA_HUGE_PAGES) {
+        // Needs the "Lock pages in memory" privilege; fails cleanly without it.
+        SIZE_T large = GetLargePageMinimum();
+        if (large > 0) {
+            void* block = VirtualAlloc(NULL, RoundUp(size, large),
+                MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (block) {
+                *hugePages = 1;
+                return (uint8_t*)block;
+            }
+        }
+    }
+    return (uint8_t*)VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#elif defined(__linux__)
+    size_t mapped = RoundUp(size, ARENA_HUGE_PAGE_SIZE);
+#ifdef MAP_HUGETLB
+    if (flags & ARENA_HUGE_PAGES) {
+        void* block = mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (block != MAP_FAILED) {
+            *hugePages = 1;
+            return (uint8_t*)block;
+        }
+    }
+#endif
+    void* block = mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (block == MAP_FAILED) {
+        return NULL;
+    }
+#ifdef MADV_HUGEPAGE
+    if (flags & ARENA_HUGE_PAGES) {
+        // Transparent huge pages, when no hugetlbfs pages are reserved.
+        madvise(block, mapped, MADV_HUGEPAGE);
+    }
+#endif
+    return (uint8_t*)block;
+#else
+    (void)flags;
+    return (uint8_t*)malloc(size);
+#endif
+}
+
+static void FreeBlock(uint8_t* block, size_t size) {
+#if defined(_WIN32)
+    (void)size;
+    VirtualFree(block, 0, MEM_RELEASE);
+#elif defined(__linux__)
+    munmap(block, RoundUp(size, ARENA_HUGE_PAGE_SIZE));
+#else
+    (void)size;
+    free(block);
+#endif
+}
+
+int Arena_Init(Arena* arena, size_t size, int flags) {
+    memset(arena, 0, sizeof(*arena));
+    arena->base = AllocBlock(size, flags, &arena->hugePages);
+    if (!arena->base) {
+        return -1;
+    }
+    arena->size = size;
+    arena->owner = 1;
+    return 0;
+}
+
+int Arena_InitFromParent(Arena* arena, Arena* parent, size_t size) {
+    memset(arena, 0, sizeof(*arena));
+    arena->base = (uint8_t*)Arena_Alloc(parent, size, ARENA_CACHE_LINE);
+    if (!arena->base) {
+        return -1;
+    }
+    arena->size = size;
+    arena->hugePages = parent->hugePages;
+    return 0;
+}
+
+void Arena_Destroy(Arena* arena) {
+    if (arena->owner && arena->base) {
+        FreeBlock(arena->base, arena->size);
+    }
+    memset(arena, 0, sizeof(*arena));
+}
+
+void* Arena_Alloc(Arena* arena, size_t size, size_t align) {
+    assert(align > 0 && (align & (align - 1)) == 0 && "Alignment must be a power of two.");
+    // Align the address rather than the offset, so alignments above the block's
+    // own alignment still hold.
+    uintptr_t start = RoundUp((uintptr_t)arena->base + arena->used, align);
+    size_t offset = (size_t)(start - (uintptr_t)arena->base);
+    if (offset > arena->size || size > arena->size - offset) {
+        return NULL;
+    }
+    arena->used = offset + size;
+    if (arena->used > arena->highWater) {
+        arena->highWater = arena->used;
+    }
+    return (void*)start;
+}
+
+void* Arena_AllocZero(Arena* arena, size_t size, size_t align) {
+    void* memory = Arena_Alloc(arena, size, align);
+    if (memory) {
+        memset(memory, 0, size);
+    }
+    return memory;
+}
+
+size_t Arena_Mark(const Arena* arena) {
+    return arena->used;
+}
+
+void Arena_ResetTo(Arena* arena, size_t mark) {
+    assert(mark <= arena->used && "Mark is past the current position.");
+    arena->used = mark;
+}
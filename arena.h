@@ -0,0 +1,54 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Allocations default to cache-line alignment, which also covers SSE/AVX loads.
+#define ARENA_CACHE_LINE 64
+
+// Arena_Init flags.
+#define ARENA_HUGE_PAGES 0x1   // Try to back the arena with large pages; falls back silently.
+
+// A linear allocator over one contiguous block. Individual allocations are never
+// freed; the whole arena is reset (O(1)) or destroyed at once.
+typedef struct Arena {
+    uint8_t* base;
+    size_t size;
+    size_t used;
+    size_t highWater;     // Largest `used` seen, for sizing the arena.
+    int hugePages;        // Backed by large pages.
+    int owner;            // 1 if the block was allocated by Arena_Init.
+} Arena;
+
+// Reserve size bytes. Returns 0 on success.
+int Arena_Init(Arena* arena, size_t size, int flags);
+
+// Carve a child arena (e.g. a per-frame scratch arena) out of a parent. The child
+// is reset on its own and goes away with the parent. Returns 0 on success.
+int Arena_InitFromParent(Arena* arena, Arena* parent, size_t size);
+
+// Release the block (no-op for child arenas).
+void Arena_Destroy(Arena* arena);
+
+// Allocate size bytes aligned to align (a power of two). Returns NULL when full.
+void* Arena_Alloc(Arena* arena, size_t size, size_t align);
+
+// Same as Arena_Alloc, zero-filled.
+void* Arena_AllocZero(Arena* arena, size_t size, size_t align);
+
+// Save and restore the allocation position. Everything allocated after the mark is
+// discarded by Arena_ResetTo.
+size_t Arena_Mark(const Arena* arena);
+void Arena_ResetTo(Arena* arena, size_t mark);
+
+// Discard every allocation.
+static inline void Arena_Reset(Arena* arena) {
+    arena->used = 0;
+}
+
+// Cache-line aligned allocation of one T / count Ts.
+#define ARENA_NEW(arena, T) ((T*)Arena_Alloc((arena), sizeof(T), ARENA_CACHE_LINE))
+#define ARENA_NEW_ARRAY(arena, T, count) ((T*)Arena_Alloc((arena), sizeof(T) * (size_t)(count), ARENA_CACHE_LINE))
+
+#endif // ARENA_H
@@ -0,0 +1,826 @@
+#include "benchmark.h"
+#include "contact_solver.h"
+#include "world.h"
+#include "replication.h"
+#include "spatial_sort.h"
+#include "math3d.h"
+#include "tags.h"
+#include "entity_allocator.h"
+#include "ComponentArray.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_STEPS 30
+
+static double ElapsedMs(Uint64 start) {
+    return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+// --- contacts: stacked cube scenes solved serially and on the job pool ---
+
+// Columns of unit cubes (as spheres) on the ground, side by side so each touches its
+// neighbours. Stacked cubes start slightly overlapping; neighbouring columns overlap
+// by less than the slop so they touch without being pushed apart.
+static int BuildStacks(ContactSolver* solver, int width, int height) {
+    const float spacing = 0.98f;
+    const float columnSpacing = 0.995f;
+    if (ContactSolver_SetBodyCount(solver, width * width * height) != 0) {
+        return -1;
+    }
+    int i = 0;
+    for (int x = 0; x < width; x++) {
+        for (int z = 0; z < width; z++) {
+            for (int y = 0; y < height; y++, i++) {
+                solver->px[i] = x * columnSpacing;
+                solver->py[i] = 0.49f + y * spacing;
+                solver->pz[i] = z * columnSpacing;
+                solver->vx[i] = solver->vy[i] = solver->vz[i] = 0.0f;
+                solver->invMass[i] = 1.0f;
+                solver->radius[i] = 0.5f;
+                solver->dt[i] = 0.0f;
+                solver->asleep[i] = 0;
+            }
+        }
+    }
+    return 0;
+}
+
+typedef struct {
+    double findMs, colorMs, solveMs;
+    int contacts, colors;     // Contacts averaged over the steps.
+    float maxPenetration;
+} StackResult;
+
+static int RunStacks(JobSystem* jobs, int width, int height, StackResult* result) {
+    const float dt = 1.0f / 60.0f;
+    ContactSolver solver;
+    ContactSolver_Init(&solver, jobs);
+    if (BuildStacks(&solver, width, height) != 0) {
+        ContactSolver_Shutdown(&solver);
+        return -1;
+    }
+    memset(result, 0, sizeof(*result));
+
+    for (int step = 0; step < BENCH_STEPS; step++) {
+        for (int i = 0; i < solver.bodyCount; i++) {
+            solver.vy[i] -= 9.8f * dt;
+        }
+        Uint64 start = SDL_GetPerformanceCounter();
+        int failed = ContactSolver_FindContacts(&solver, 1, 0.0f) != 0;
+        result->findMs += ElapsedMs(start);
+        start = SDL_GetPerformanceCounter();
+        failed = failed || ContactSolver_Color(&solver, dt) != 0;
+        result->colorMs += ElapsedMs(start);
+        if (failed) {
+            ContactSolver_Shutdown(&solver);
+            return -1;
+        }
+        start = SDL_GetPerformanceCounter();
+        ContactSolver_Solve(&solver);
+        result->solveMs += ElapsedMs(start);
+        result->contacts += solver.contactCount;
+
+        for (int i = 0; i < solver.bodyCount; i++) {
+            solver.px[i] += solver.vx[i] * dt;
+            solver.py[i] += solver.vy[i] * dt;
+            solver.pz[i] += solver.vz[i] * dt;
+        }
+    }
+
+    result->findMs /= BENCH_STEPS;
+    result->colorMs /= BENCH_STEPS;
+    result->solveMs /= BENCH_STEPS;
+    result->contacts /= BENCH_STEPS;
+    result->colors = solver.colorCount;
+    for (int c = 0; c < solver.contactCount; c++) {
+        if (solver.contacts[c].penetration > result->maxPenetration) {
+            result->maxPenetration = solver.contacts[c].penetration;
+        }
+    }
+    ContactSolver_Shutdown(&solver);
+    return 0;
+}
+
+// Step a falling-blocks world until every body is asleep. Returns 0 if that happens
+// within maxFrames.
+static int CheckSettles(JobSystem* jobs, int blocks, int maxFrames) {
+    WorldConfig config;
+    WorldConfig_Default(&config);
+    config.jobs = jobs;
+    config.seed = 4321;
+    config.loadModules = 0;
+    World* world = malloc(sizeof(World));
+    if (!world || World_Init(world, &config) != 0) {
+        free(world);
+        return -1;
+    }
+    World_SpawnFallingBlocks(world, blocks);
+    const PhysicsSystem* physics = world->physicsSystem;
+    // New bodies join the active set on the first step.
+    int frame = 0;
+    do {
+        World_Step(world, 0.016f);
+        frame++;
+    } while (frame < maxFrames && physics->activeCount > 0);
+    int awake = physics->activeCount;
+    printf("  %5d blocks: %4d of %d bodies awake after %d frames\n", blocks, awake, physics->base.count, frame);
+    World_Destroy(world);
+    free(world);
+    return awake == 0 ? 0 : 1;
+}
+
+static int BenchContacts(JobSystem* jobs) {
+    static const int targets[] = { 10000, 100000 };
+    static const int settleBlocks[] = { 1000, 3000 };
+    const int height = 10;
+    printf("contacts: %d steps of stacked unit cubes, %d threads\n", BENCH_STEPS, JobSystem_GetThreadCount(jobs));
+    printf("%9s %8s %7s %9s %9s %11s %11s %8s %9s\n",
+        "contacts", "bodies", "colors", "find ms", "color ms", "solve 1t ms", "solve Nt ms", "speedup", "max pen");
+
+    for (size_t t = 0; t < sizeof(targets) / sizeof(targets[0]); t++) {
+        // About three contacts per cube in a stack lattice.
+        int width = 2;
+        while (3 * width * width * height < targets[t]) {
+            width++;
+        }
+        StackResult serial, parallel;
+        if (RunStacks(NULL, width, height, &serial) != 0 || RunStacks(jobs, width, height, &parallel) != 0) {
+            fprintf(stderr, "contacts: out of memory\n");
+            return 1;
+        }
+        printf("%9d %8d %7d %9.3f %9.3f %11.3f %11.3f %7.2fx %9.4f\n",
+            parallel.contacts, width * width * height, parallel.colors, parallel.findMs, parallel.colorMs,
+            serial.solveMs, parallel.solveMs,
+            parallel.solveMs > 0.0 ? serial.solveMs / parallel.solveMs : 0.0, parallel.maxPenetration);
+    }
+
+    // Piles have to fall asleep, or sleeping buys nothing once bodies stack.
+    printf("settle: falling blocks with the world's contact solver, 3000 frames at most\n");
+    int unsettled = 0;
+    for (size_t i = 0; i < sizeof(settleBlocks) / sizeof(settleBlocks[0]); i++) {
+        int result = CheckSettles(jobs, settleBlocks[i], 3000);
+        if (result < 0) {
+            fprintf(stderr, "contacts: out of memory\n");
+            return 1;
+        }
+        unsettled += result;
+    }
+    return unsettled ? 1 : 0;
+}
+
+// --- replication: delta stream of the falling-blocks world over a lossy loopback ---
+
+static int BenchReplication(JobSystem* jobs) {
+    const int frames = 600;
+    const int window = 60;
+    WorldConfig config;
+    WorldConfig_Default(&config);
+    config.jobs = jobs;
+    config.seed = 12345;
+    config.loadModules = 0;
+    World world;
+    if (World_Init(&world, &config) != 0) {
+        return 1;
+    }
+    World_SpawnFallingBlocks(&world, 200);
+
+    ReplicationLoopback link;
+    if (ReplicationLoopback_Init(&link, 3, 0.05f, 99) != 0) {
+        World_Destroy(&world);
+        return 1;
+    }
+
+    long long firstBytes = 0, lastBytes = 0;
+    int mismatches = 0;
+    int failed = 0;
+    for (int frame = 0; frame < frames && !failed; frame++) {
+        World_Step(&world, 0.016f);
+        long long before = link.bytesSent;
+        if (ReplicationLoopback_Tick(&link, world.transformArray, world.rigidBodyArray) != 0) {
+            failed = 1;
+            break;
+        }
+        if (frame < window) firstBytes += link.bytesSent - before;
+        if (frame >= frames - window) lastBytes += link.bytesSent - before;
+
+        // The receiver's newest frame must match what was sent for it, bit for bit.
+        uint32_t seq = link.receiver.latestSeq;
+        for (Entity e = 0; seq != 0 && e < (Entity)link.encoder.entityLimit; e++) {
+            const ReplState* sent = ReplicationEncoder_GetSent(&link.encoder, seq, e);
+            const ReplState* received = ReplicationReceiver_GetState(&link.receiver, seq, e);
+            if (!sent || !received || memcmp(sent, received, sizeof(ReplState)) != 0) {
+                mismatches++;
+            }
+        }
+    }
+
+    int entities = (int)world.transformArray->size;
+    int rawBytes = entities * (int)(sizeof(Transform) + sizeof(Vec3));
+    printf("replication: %d frames, %d entities, latency 3 frames each way, 5%% loss\n", frames, entities);
+    printf("  raw state            %8d bytes/frame\n", rawBytes);
+    printf("  stream, first %d     %8.1f bytes/frame\n", window, (double)firstBytes / window);
+    printf("  stream, last %d      %8.1f bytes/frame\n", window, (double)lastBytes / window);
+    printf("  stream, average      %8.1f bytes/frame, %.1f entities/frame\n",
+        (double)link.bytesSent / link.packetsSent, (double)link.entitiesSent / link.packetsSent);
+    printf("  packets              %d sent, %d lost, %d rejected, %d full\n",
+        link.packetsSent, link.packetsLost, link.packetsRejected, link.fullPackets);
+    printf("  receiver mismatches  %d\n", mismatches);
+
+    ReplicationLoopback_Shutdown(&link);
+    World_Destroy(&world);
+    return (failed || mismatches) ? 1 : 0;
+}
+
+// --- morton: neighbour queries over a Transform array before and after sorting ---
+
+#define MORTON_GRID 32
+
+// Uniform grid over [0, extent)^3 of entity lists, filled in dense order.
+typedef struct {
+    int cellStart[MORTON_GRID * MORTON_GRID * MORTON_GRID + 1];
+    Entity* entries;
+} NeighbourGrid;
+
+static inline int GridCoord(float v, float cellSize) {
+    int c = (int)(v / cellSize);
+    return c < 0 ? 0 : (c >= MORTON_GRID ? MORTON_GRID - 1 : c);
+}
+
+static inline int GridCell(Vec3 p, float cellSize) {
+    return (GridCoord(p.x, cellSize) * MORTON_GRID + GridCoord(p.y, cellSize)) * MORTON_GRID + GridCoord(p.z, cellSize);
+}
+
+static void BuildGrid(NeighbourGrid* grid, const TransformComponentArray* transforms, float cellSize) {
+    const int cells = MORTON_GRID * MORTON_GRID * MORTON_GRID;
+    memset(grid->cellStart, 0, sizeof(grid->cellStart));
+    for (size_t i = 0; i < transforms->size; i++) {
+        grid->cellStart[GridCell(transforms->components[i].position, cellSize) + 1]++;
+    }
+    for (int c = 0; c < cells; c++) {
+        grid->cellStart[c + 1] += grid->cellStart[c];
+    }
+    int fill[MORTON_GRID * MORTON_GRID * MORTON_GRID];
+    memcpy(fill, grid->cellStart, sizeof(fill));
+    for (size_t i = 0; i < transforms->size; i++) {
+        grid->entries[fill[GridCell(transforms->components[i].position, cellSize)]++] = transforms->indexToEntityMap[i];
+    }
+}
+
+// For every entity in dense order, visit the entities of the surrounding cells and
+// count those within cellSize. Neighbours are read through the entity map, the way a
+// system would.
+static long long QueryNeighbours(const NeighbourGrid* grid, TransformComponentArray* transforms, float cellSize) {
+    long long pairs = 0;
+    float radiusSq = cellSize * cellSize;
+    for (size_t i = 0; i < transforms->size; i++) {
+        Vec3 p = transforms->components[i].position;
+        int cx = GridCoord(p.x, cellSize), cy = GridCoord(p.y, cellSize), cz = GridCoord(p.z, cellSize);
+        for (int x = cx - 1; x <= cx + 1; x++) {
+            for (int y = cy - 1; y <= cy + 1; y++) {
+                for (int z = cz - 1; z <= cz + 1; z++) {
+                    if (x < 0 || y < 0 || z < 0 || x >= MORTON_GRID || y >= MORTON_GRID || z >= MORTON_GRID) {
+                        continue;
+                    }
+                    int cell = (x * MORTON_GRID + y) * MORTON_GRID + z;
+                    for (int k = grid->cellStart[cell]; k < grid->cellStart[cell + 1]; k++) {
+                        Vec3 q = TransformComponentArray_GetData(transforms, grid->entries[k])->position;
+                        Vec3 d = Vec3_Sub(p, q);
+                        pairs += Vec3_Dot(d, d) < radiusSq;
+                    }
+                }
+            }
+        }
+    }
+    return pairs;
+}
+
+static double TimeQueries(NeighbourGrid* grid, TransformComponentArray* transforms, float cellSize, int repeats, long long* pairs) {
+    BuildGrid(grid, transforms, cellSize);
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int r = 0; r < repeats; r++) {
+        *pairs = QueryNeighbours(grid, transforms, cellSize);
+    }
+    return ElapsedMs(start) / repeats;
+}
+
+// Every dense entry and its entity agree in both maps.
+static int MapsConsistent(const TransformComponentArray* transforms) {
+    for (size_t i = 0; i < transforms->size; i++) {
+        if (transforms->entityToIndexMap[transforms->indexToEntityMap[i]] != (int)i) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int BenchMorton(JobSystem* jobs) {
+    const int count = MAX_ENTITIES;
+    const float extent = 100.0f;
+    const float cellSize = extent / MORTON_GRID;
+    const int repeats = 20;
+    const int swapsPerFrame = 500;
+
+    TransformComponentArray* transforms = malloc(sizeof(TransformComponentArray));
+    NeighbourGrid* grid = malloc(sizeof(NeighbourGrid));
+    Entity* entries = malloc(sizeof(Entity) * (size_t)count);
+    Arena arena;
+    int failed = !transforms || !grid || !entries || Arena_Init(&arena, 1u << 20, 0) != 0;
+    if (failed) {
+        free(transforms);
+        free(grid);
+        free(entries);
+        return 1;
+    }
+    grid->entries = entries;
+
+    // Random positions, inserted in entity order: memory order has nothing to do with space.
+    uint32_t rng = 2024;
+    TransformComponentArray_Init(transforms);
+    for (int i = 0; i < count; i++) {
+        Transform t = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f } };
+        float* axes[3] = { &t.position.x, &t.position.y, &t.position.z };
+        for (int a = 0; a < 3; a++) {
+            rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+            *axes[a] = (float)(rng >> 8) / (float)(1u << 24) * extent;
+        }
+        TransformComponentArray_Insert(transforms, (uint32_t)i, t);
+    }
+
+    long long pairsBefore = 0, pairsAfter = 0;
+    double beforeMs = TimeQueries(grid, transforms, cellSize, repeats, &pairsBefore);
+
+    // Amortized sort, as a world would run it between steps.
+    SpatialSort sort;
+    int frames = 0;
+    if (SpatialSort_Init(&sort, &arena, transforms, swapsPerFrame) != 0) {
+        failed = 1;
+    }
+    Uint64 sortStart = SDL_GetPerformanceCounter();
+    while (!failed && sort.passes == 0) {
+        SpatialSort_Step(&sort);
+        frames++;
+    }
+    double sortMs = ElapsedMs(sortStart);
+    double afterMs = TimeQueries(grid, transforms, cellSize, repeats, &pairsAfter);
+    int consistent = MapsConsistent(transforms);
+
+    // A full world with the sort enabled must stay consistent while it runs.
+    WorldConfig config;
+    WorldConfig_Default(&config);
+    config.jobs = jobs;
+    config.seed = 99;
+    config.loadModules = 0;
+    config.spatialSortSwaps = 256;
+    World* world = malloc(sizeof(World));
+    int worldOk = world && World_Init(world, &config) == 0;
+    if (worldOk) {
+        World_SpawnFallingBlocks(world, 2000);
+        for (int frame = 0; frame < 300; frame++) {
+            World_Step(world, 0.016f);
+        }
+        worldOk = MapsConsistent(world->transformArray);
+    }
+
+    printf("morton: %d entities in a %.0f^3 box, %d^3 grid, radius %.2f\n", count, extent, MORTON_GRID, cellSize);
+    printf("  insertion order      %8.3f ms per query pass, %lld pairs\n", beforeMs, pairsBefore);
+    printf("  Morton order         %8.3f ms per query pass, %lld pairs (%.2fx)\n", afterMs, pairsAfter,
+        afterMs > 0.0 ? beforeMs / afterMs : 0.0);
+    printf("  sort                 %d frames at %d swaps, %llu swaps, %.3f ms total\n",
+        frames, swapsPerFrame, (unsigned long long)sort.swaps, sortMs);
+    printf("  maps consistent      %s; world with sort: %s", consistent ? "yes" : "NO", worldOk ? "consistent" : "FAILED");
+    if (worldOk) {
+        printf(" (%u plans, %u applied, %llu swaps)", world->spatialSort->plans, world->spatialSort->passes,
+            (unsigned long long)world->spatialSort->swaps);
+    }
+    printf("\n");
+
+    if (world) {
+        World_Destroy(world);
+        free(world);
+    }
+    Arena_Destroy(&arena);
+    free(entries);
+    free(grid);
+    free(transforms);
+    return (failed || !consistent || !worldOk || pairsBefore != pairsAfter) ? 1 : 0;
+}
+
+// --- tags: marker queries as bitsets, signature scans and component arrays ---
+
+// What a marker costs when it has to be a component.
+typedef struct {
+    uint8_t unused;
+} MarkerComponent;
+
+DEFINE_COMPONENT_ARRAY(MarkerComponent)
+
+static int BenchTags(JobSystem* jobs) {
+    (void)jobs;
+    const int repeats = 200;
+    EntityManager* entities = malloc(sizeof(EntityManager));
+    MarkerComponentComponentArray* markers[2] = { malloc(sizeof(MarkerComponentComponentArray)), malloc(sizeof(MarkerComponentComponentArray)) };
+    TagBitset* sets[2] = { malloc(sizeof(TagBitset)), malloc(sizeof(TagBitset)) };
+    Entity* out = malloc(sizeof(Entity) * MAX_ENTITIES);
+    if (!entities || !markers[0] || !markers[1] || !sets[0] || !sets[1] || !out) {
+        free(entities); free(markers[0]); free(markers[1]); free(sets[0]); free(sets[1]); free(out);
+        return 1;
+    }
+
+    // Every entity alive; about 30% are static, about half of all entities selected.
+    EntityManager_Init(entities);
+    MarkerComponentComponentArray_Init(markers[0]);
+    MarkerComponentComponentArray_Init(markers[1]);
+    TagBitset_Init(sets[0]);
+    TagBitset_Init(sets[1]);
+    uint32_t rng = 4242;
+    MarkerComponent marker = { 0 };
+    for (int i = 0; i < MAX_ENTITIES; i++) {
+        Entity e = EntityManager_CreateEntity(entities);
+        rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+        Signature signature = 1u << COMPONENT_TRANSFORM;
+        if (rng % 10 < 3) {
+            signature |= 1u << TAG_STATIC;
+            TagBitset_Set(sets[0], e);
+            MarkerComponentComponentArray_Insert(markers[0], e, marker);
+        }
+        if ((rng >> 8) % 2 == 0) {
+            signature |= 1u << TAG_SELECTED;
+            TagBitset_Set(sets[1], e);
+            MarkerComponentComponentArray_Insert(markers[1], e, marker);
+        }
+        EntityManager_SetSignature(entities, e, signature);
+    }
+
+    // Static and not selected.
+    int bitsetCount = 0, scanCount = 0, arrayCount = 0;
+    TagQuery query = { { sets[0] }, 1, { sets[1] }, 1 };
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int r = 0; r < repeats; r++) {
+        bitsetCount = TagQuery_Collect(&query, out, MAX_ENTITIES);
+    }
+    double bitsetMs = ElapsedMs(start) / repeats;
+
+    start = SDL_GetPerformanceCounter();
+    for (int r = 0; r < repeats; r++) {
+        scanCount = 0;
+        for (Entity e = 0; e < MAX_ENTITIES; e++) {
+            Signature s = entities->signatures[e];
+            if ((s & (1u << TAG_STATIC)) && !(s & (1u << TAG_SELECTED))) {
+                out[scanCount++] = e;
+            }
+        }
+    }
+    double scanMs = ElapsedMs(start) / repeats;
+
+    start = SDL_GetPerformanceCounter();
+    for (int r = 0; r < repeats; r++) {
+        arrayCount = 0;
+        for (size_t i = 0; i < markers[0]->size; i++) {
+            Entity e = markers[0]->indexToEntityMap[i];
+            if (markers[1]->entityToIndexMap[e] == -1) {
+                out[arrayCount++] = e;
+            }
+        }
+    }
+    double arrayMs = ElapsedMs(start) / repeats;
+
+    printf("tags: %d entities, %d static, %d selected; query static and not selected\n",
+        MAX_ENTITIES, sets[0]->count, sets[1]->count);
+    printf("  bitset query         %8.4f ms, %d matches, %zu bytes per tag\n", bitsetMs, bitsetCount, sizeof(TagBitset));
+    printf("  signature scan       %8.4f ms, %d matches, no extra storage\n", scanMs, scanCount);
+    printf("  component arrays     %8.4f ms, %d matches, %zu bytes per marker\n", arrayMs, arrayCount,
+        sizeof(MarkerComponentComponentArray));
+
+    int result = (bitsetCount == scanCount && scanCount == arrayCount) ? 0 : 1;
+    free(entities); free(markers[0]); free(markers[1]); free(sets[0]); free(sets[1]); free(out);
+    return result;
+}
+
+typedef struct {
+    const char* name;
+    int (*run)(JobSystem* jobs);
+    const char* description;
+} BenchmarkEntry;
+
+// --- lod: physics steps with every body ticked every frame vs. update-rate LOD ---
+
+// Settle a scene with and without LOD, then time physics steps at rest: with
+// nothing awake both should cost next to nothing.
+static int BenchLodResting(JobSystem* jobs) {
+    const int blocks = 3000;
+    const int maxFrames = 8000;
+    const int frames = 300;
+    WorldConfig config;
+    WorldConfig_Default(&config);
+    config.jobs = jobs;
+    config.seed = 4321;
+    config.loadModules = 0;
+
+    World* worlds[2] = { malloc(sizeof(World)), malloc(sizeof(World)) };
+    int created = 0;
+    for (; created < 2; created++) {
+        config.updateLod = created;
+        if (!worlds[created] || World_Init(worlds[created], &config) != 0) {
+            break;
+        }
+        World_SpawnFallingBlocks(worlds[created], blocks);
+    }
+
+    int failed = created != 2;
+    for (int w = 0; w < 2 && !failed; w++) {
+        PhysicsSystem* physics = worlds[w]->physicsSystem;
+        // New bodies join the active set on the first step.
+        int frame = 0;
+        do {
+            PhysicsSystem_Update(physics, 0.016f);
+            frame++;
+        } while (frame < maxFrames && physics->activeCount > 0);
+
+        const UpdateLod* lod = worlds[w]->updateLod;
+        uint64_t ticks = lod ? lod->ticks : 0;
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int i = 0; i < frames; i++) {
+            PhysicsSystem_Update(physics, 0.016f);
+        }
+        double ms = ElapsedMs(start) / frames;
+        printf("  at rest, %-15s %8.4f ms/frame physics, %d of %d awake after %d frames",
+            lod ? "update-rate LOD" : "every body", ms, physics->activeCount, physics->base.count, frame);
+        if (lod) {
+            printf(", %.1f ticked per frame", (double)(lod->ticks - ticks) / frames);
+        }
+        printf("\n");
+        // At rest nothing is awake, so nothing should be due either.
+        failed |= physics->activeCount > 0 || (lod && lod->ticks != ticks);
+    }
+    for (int i = 0; i < created; i++) {
+        World_Destroy(worlds[i]);
+    }
+    free(worlds[0]);
+    free(worlds[1]);
+    return failed ? 1 : 0;
+}
+
+static int BenchLod(JobSystem* jobs) {
+    const int frames = 300;
+    const int blocks = 9000;
+    WorldConfig config;
+    WorldConfig_Default(&config);
+    config.jobs = jobs;
+    config.seed = 99;
+    config.loadModules = 0;
+
+    // The same scene twice; only the second ticks distant bodies less often.
+    World* worlds[2] = { malloc(sizeof(World)), malloc(sizeof(World)) };
+    int created = 0;
+    for (; created < 2; created++) {
+        config.updateLod = created;
+        if (!worlds[created] || World_Init(worlds[created], &config) != 0) {
+            break;
+        }
+        World_SpawnFallingBlocks(worlds[created], blocks);
+    }
+
+    int failed = created != 2;
+    double stepMs[2] = { 0.0, 0.0 };
+    for (int frame = 0; frame < frames && !failed; frame++) {
+        for (int k = 0; k < 2; k++) {
+            int w = (frame + k) & 1;
+            Uint64 start = SDL_GetPerformanceCounter();
+            World_Step(worlds[w], 0.016f);
+            stepMs[w] += ElapsedMs(start);
+        }
+    }
+
+    if (!failed) {
+        const UpdateLod* lod = worlds[1]->updateLod;
+        printf("lod: %d frames, %d physics bodies, focus at the camera\n", frames, worlds[0]->physicsSystem->base.count);
+        printf("  every body every frame   %8.3f ms/frame, %d awake at end\n",
+            stepMs[0] / frames, worlds[0]->physicsSystem->activeCount);
+        printf("  update-rate LOD          %8.3f ms/frame, %d awake at end (%.2fx)\n",
+            stepMs[1] / frames, worlds[1]->physicsSystem->activeCount, stepMs[1] > 0.0 ? stepMs[0] / stepMs[1] : 0.0);
+        printf("  bodies ticked per frame  %8.1f of %d, %u bucket rebuilds\n",
+            (double)lod->ticks / (double)lod->frame, worlds[1]->physicsSystem->base.count, lod->rebuilds);
+    }
+    for (int i = 0; i < created; i++) {
+        World_Destroy(worlds[i]);
+    }
+    free(worlds[0]);
+    free(worlds[1]);
+    if (failed) {
+        return 1;
+    }
+    return BenchLodResting(jobs);
+}
+
+// --- entities: concurrent ID allocation vs. a mutex around the EntityManager ---
+
+#define ENTITY_BENCH_BATCH 256
+#define ENTITY_BENCH_MAX_THREADS 8
+
+typedef struct {
+    EntityAllocator* allocator;
+    EntityManager* manager;   // Locked baseline.
+    SDL_Mutex* mutex;
+    int rounds;
+    Entity* ids;              // Stress: the IDs this thread created.
+    int idCount;
+} EntityBenchThread;
+
+// Create a batch, destroy it, repeat.
+static int ChurnCached(void* data) {
+    EntityBenchThread* t = (EntityBenchThread*)data;
+    EntityIdCache cache;
+    EntityIdCache_Init(&cache, t->allocator);
+    Entity batch[ENTITY_BENCH_BATCH];
+    for (int r = 0; r < t->rounds; r++) {
+        for (int i = 0; i < ENTITY_BENCH_BATCH; i++) {
+            batch[i] = EntityIdCache_Create(&cache);
+        }
+        for (int i = 0; i < ENTITY_BENCH_BATCH; i++) {
+            EntityIdCache_Destroy(&cache, batch[i]);
+        }
+    }
+    EntityIdCache_Flush(&cache);
+    return 0;
+}
+
+static int ChurnLocked(void* data) {
+    EntityBenchThread* t = (EntityBenchThread*)data;
+    Entity batch[ENTITY_BENCH_BATCH];
+    for (int r = 0; r < t->rounds; r++) {
+        for (int i = 0; i < ENTITY_BENCH_BATCH; i++) {
+            SDL_LockMutex(t->mutex);
+            batch[i] = EntityManager_CreateEntity(t->manager);
+            SDL_UnlockMutex(t->mutex);
+        }
+        for (int i = 0; i < ENTITY_BENCH_BATCH; i++) {
+            SDL_LockMutex(t->mutex);
+            EntityManager_DestroyEntity(t->manager, batch[i]);
+            SDL_UnlockMutex(t->mutex);
+        }
+    }
+    return 0;
+}
+
+// Create until the allocator runs dry.
+static int StressCreate(void* data) {
+    EntityBenchThread* t = (EntityBenchThread*)data;
+    EntityIdCache cache;
+    EntityIdCache_Init(&cache, t->allocator);
+    t->idCount = 0;
+    for (Entity e = EntityIdCache_Create(&cache); e != ENTITY_ALLOCATOR_EMPTY; e = EntityIdCache_Create(&cache)) {
+        t->ids[t->idCount++] = e;
+        // Flush now and then so blocks keep moving between threads.
+        if (t->idCount % 1000 == 0) {
+            EntityIdCache_Flush(&cache);
+        }
+    }
+    EntityIdCache_Flush(&cache);
+    return 0;
+}
+
+static int StressDestroy(void* data) {
+    EntityBenchThread* t = (EntityBenchThread*)data;
+    EntityIdCache cache;
+    EntityIdCache_Init(&cache, t->allocator);
+    for (int i = 0; i < t->idCount; i++) {
+        EntityIdCache_Destroy(&cache, t->ids[i]);
+    }
+    EntityIdCache_Flush(&cache);
+    return 0;
+}
+
+// Run fn on threadCount threads and return the wall time.
+static double RunEntityThreads(SDL_ThreadFunction fn, EntityBenchThread* threads, int threadCount) {
+    SDL_Thread* handles[ENTITY_BENCH_MAX_THREADS];
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < threadCount; i++) {
+        handles[i] = SDL_CreateThread(fn, "EntityBench", &threads[i]);
+    }
+    for (int i = 0; i < threadCount; i++) {
+        if (handles[i]) {
+            SDL_WaitThread(handles[i], NULL);
+        }
+        else {
+            fn(&threads[i]);
+        }
+    }
+    return ElapsedMs(start);
+}
+
+// Every ID exactly once across the threads' lists (and none outside [0, MAX_ENTITIES)).
+static int EntityListsDisjoint(const EntityBenchThread* threads, int threadCount, uint8_t* seen, int* total) {
+    memset(seen, 0, MAX_ENTITIES);
+    *total = 0;
+    for (int t = 0; t < threadCount; t++) {
+        for (int i = 0; i < threads[t].idCount; i++) {
+            Entity e = threads[t].ids[i];
+            if (e >= MAX_ENTITIES || seen[e]) {
+                return 0;
+            }
+            seen[e] = 1;
+        }
+        *total += threads[t].idCount;
+    }
+    return 1;
+}
+
+static int BenchEntities(JobSystem* jobs) {
+    (void)jobs;
+    const int rounds = 2000;
+    EntityManager* manager = malloc(sizeof(EntityManager));
+    EntityAllocator* allocator = malloc(sizeof(EntityAllocator));
+    Entity* idStorage = malloc(sizeof(Entity) * MAX_ENTITIES * ENTITY_BENCH_MAX_THREADS);
+    uint8_t* seen = malloc(MAX_ENTITIES);
+    SDL_Mutex* mutex = SDL_CreateMutex();
+    if (!manager || !allocator || !idStorage || !seen || !mutex) {
+        free(manager); free(allocator); free(idStorage); free(seen);
+        if (mutex) SDL_DestroyMutex(mutex);
+        return 1;
+    }
+    EntityBenchThread threads[ENTITY_BENCH_MAX_THREADS];
+    for (int i = 0; i < ENTITY_BENCH_MAX_THREADS; i++) {
+        threads[i].allocator = allocator;
+        threads[i].manager = manager;
+        threads[i].mutex = mutex;
+        threads[i].rounds = rounds;
+        threads[i].ids = idStorage + (size_t)i * MAX_ENTITIES;
+        threads[i].idCount = 0;
+    }
+
+    printf("entities: %d create+destroy pairs per thread, in batches of %d\n", rounds * ENTITY_BENCH_BATCH, ENTITY_BENCH_BATCH);
+    printf(" threads  lock-free Mops/s  mutex Mops/s  speedup\n");
+    int failed = 0;
+    for (int threadCount = 1; threadCount <= ENTITY_BENCH_MAX_THREADS; threadCount *= 2) {
+        double ops = 2.0 * rounds * ENTITY_BENCH_BATCH * threadCount;
+        EntityManager_Init(manager);
+        EntityAllocator_Begin(allocator, manager, 0);
+        double cachedMs = RunEntityThreads(ChurnCached, threads, threadCount);
+        EntityAllocator_End(allocator);
+        failed |= manager->count != MAX_ENTITIES || manager->LivingEntityCount != 0;
+
+        EntityManager_Init(manager);
+        double lockedMs = RunEntityThreads(ChurnLocked, threads, threadCount);
+        printf(" %7d  %16.1f  %12.1f  %6.2fx\n", threadCount, ops / (cachedMs * 1000.0), ops / (lockedMs * 1000.0),
+            cachedMs > 0.0 ? lockedMs / cachedMs : 0.0);
+    }
+
+    // Stress: every thread creates until no IDs are left, then destroys its own.
+    // Each ID must be handed out exactly once, and all of them must come back.
+    int stressFailures = 0;
+    for (int pass = 0; pass < 20; pass++) {
+        int total = 0;
+        EntityManager_Init(manager);
+        EntityAllocator_Begin(allocator, manager, 0);
+        RunEntityThreads(StressCreate, threads, ENTITY_BENCH_MAX_THREADS);
+        if (!EntityListsDisjoint(threads, ENTITY_BENCH_MAX_THREADS, seen, &total) || total != MAX_ENTITIES) {
+            stressFailures++;
+        }
+        RunEntityThreads(StressDestroy, threads, ENTITY_BENCH_MAX_THREADS);
+        EntityAllocator_End(allocator);
+        for (int i = 0; i < MAX_ENTITIES; i++) {
+            threads[0].ids[i] = manager->availableEntities[i];
+        }
+        threads[0].idCount = MAX_ENTITIES;
+        int queued = 0;
+        if (manager->count != MAX_ENTITIES || manager->LivingEntityCount != 0 ||
+            manager->CreatedCount != (uint64_t)MAX_ENTITIES ||
+            !EntityListsDisjoint(threads, 1, seen, &queued)) {
+            stressFailures++;
+        }
+    }
+    printf("  stress: 20 passes of %d threads draining %d IDs, %d failures\n",
+        ENTITY_BENCH_MAX_THREADS, MAX_ENTITIES, stressFailures);
+
+    free(manager); free(allocator); free(idStorage); free(seen);
+    SDL_DestroyMutex(mutex);
+    return (failed || stressFailures) ? 1 : 0;
+}
+
+static const BenchmarkEntry benchmarks[] = {
+    { "contacts", BenchContacts, "Contact solver on stacked cubes at 10k and 100k contacts" },
+    { "replication", BenchReplication, "Delta replication stream over a lossy loopback link" },
+    { "morton", BenchMorton, "Neighbour queries over a Transform array in insertion vs. Morton order" },
+    { "tags", BenchTags, "Marker queries as tag bitsets vs. signature scans vs. component arrays" },
+    { "lod", BenchLod, "Physics steps with and without update-rate LOD for distant bodies" },
+    { "entities", BenchEntities, "Concurrent entity creation: lock-free ID blocks vs. a mutex, 1-8 threads" },
+};
+
+int Benchmark_Run(const char* name, JobSystem* jobs) {
+    for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+        if (strcmp(benchmarks[i].name, name) == 0) {
+            return benchmarks[i].run(jobs);
+        }
+    }
+    fprintf(stderr, "Unknown benchmark: %s\n", name);
+    Benchmark_List();
+    return 1;
+}
+
+void Benchmark_List(void) {
+    printf("Benchmarks:\n");
+    for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+        printf("  %-12s %s\n", benchmarks[i].name, benchmarks[i].description);
+    }
+}
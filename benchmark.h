@@ -0,0 +1,13 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "job_system.h"
+
+// Run a named benchmark and print its results to stdout. Returns 0 on success,
+// non-zero for an unknown name or a failed run.
+int Benchmark_Run(const char* name, JobSystem* jobs);
+
+// Print the available benchmark names.
+void Benchmark_List(void);
+
+#endif // BENCHMARK_H
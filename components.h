@@ -15,7 +15,8 @@ typedef struct {
     float z;
 } Vec3;
 
-// Define a quaternion.
+// Define a unit quaternion (x, y, z vector part, w scalar part).
+// Transform.rotation is a real rotation; see math3d.h for the operations.
 typedef struct {
     float x;
     float y;
@@ -0,0 +1,478 @@
+#include "contact_solver.h"
+#include "math3d.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Colors beyond SOLVER_MAX_COLORS share this batch, which is solved on one thread.
+#define SOLVER_OVERFLOW_COLOR SOLVER_MAX_COLORS
+// Lane groups per parallel-for chunk.
+#define SOLVER_GROUPS_PER_CHUNK 16
+
+// An array to grow together with others that share its capacity.
+typedef struct {
+    void** array;
+    size_t elementSize;
+} SolverArray;
+
+// Reallocate every array to the new capacity. Returns 0 on success.
+static int GrowArrays(const SolverArray* arrays, int count, int capacity) {
+    for (int i = 0; i < count; i++) {
+        void* grown = realloc(*arrays[i].array, (size_t)capacity * arrays[i].elementSize);
+        if (!grown) {
+            return -1;
+        }
+        *arrays[i].array = grown;
+    }
+    return 0;
+}
+
+static int NextCapacity(int current, int needed) {
+    int capacity = current > 0 ? current : 256;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+int ContactSolver_Init(ContactSolver* solver, JobSystem* jobs) {
+    memset(solver, 0, sizeof(*solver));
+    solver->iterations = 8;
+    solver->baumgarte = 0.2f;
+    solver->slop = 0.01f;
+    solver->jobs = jobs;
+    return 0;
+}
+
+void ContactSolver_Shutdown(ContactSolver* solver) {
+    free(solver->px); free(solver->py); free(solver->pz);
+    free(solver->vx); free(solver->vy); free(solver->vz);
+    free(solver->invMass); free(solver->radius); free(solver->dt); free(solver->asleep);
+    free(solver->nextInCell); free(solver->colorMask);
+    free(solver->contacts); free(solver->contactColor);
+    free(solver->bodyA); free(solver->bodyB);
+    free(solver->nx); free(solver->ny); free(solver->nz);
+    free(solver->target); free(solver->effectiveMass); free(solver->impulse);
+    free(solver->cellHead);
+    memset(solver, 0, sizeof(*solver));
+}
+
+int ContactSolver_SetBodyCount(ContactSolver* solver, int bodyCount) {
+    assert(bodyCount >= 0 && "Body count must not be negative.");
+    if (bodyCount > solver->bodyCapacity) {
+        int capacity = NextCapacity(solver->bodyCapacity, bodyCount);
+        SolverArray arrays[] = {
+            { (void**)&solver->px, sizeof(float) }, { (void**)&solver->py, sizeof(float) },
+            { (void**)&solver->pz, sizeof(float) }, { (void**)&solver->vx, sizeof(float) },
+            { (void**)&solver->vy, sizeof(float) }, { (void**)&solver->vz, sizeof(float) },
+            { (void**)&solver->invMass, sizeof(float) }, { (void**)&solver->radius, sizeof(float) },
+            { (void**)&solver->dt, sizeof(float) },
+            { (void**)&solver->asleep, sizeof(uint8_t) }, { (void**)&solver->nextInCell, sizeof(int) },
+            { (void**)&solver->colorMask, sizeof(uint32_t) },
+        };
+        if (GrowArrays(arrays, (int)(sizeof(arrays) / sizeof(arrays[0])), capacity) != 0) {
+            return -1;
+        }
+        solver->bodyCapacity = capacity;
+    }
+    solver->bodyCount = bodyCount;
+    solver->contactCount = 0;
+    solver->colorCount = 0;
+    return 0;
+}
+
+int ContactSolver_AddContact(ContactSolver* solver, int a, int b, float nx, float ny, float nz,
+    float penetration)
+{
+    assert(a >= 0 && a < solver->bodyCount && "Contact body out of range.");
+    assert(b < solver->bodyCount && "Contact body out of range.");
+    if (solver->contactCount == solver->contactCapacity) {
+        int capacity = NextCapacity(solver->contactCapacity, solver->contactCount + 1);
+        SolverArray arrays[] = {
+            { (void**)&solver->contacts, sizeof(SolverContact) },
+            { (void**)&solver->contactColor, sizeof(uint8_t) },
+        };
+        if (GrowArrays(arrays, 2, capacity) != 0) {
+            return -1;
+        }
+        solver->contactCapacity = capacity;
+    }
+    SolverContact* c = &solver->contacts[solver->contactCount++];
+    c->bodyA = a;
+    c->bodyB = b;
+    c->nx = nx;
+    c->ny = ny;
+    c->nz = nz;
+    c->penetration = penetration;
+    solver->colorCount = 0;
+    return 0;
+}
+
+// --- Broadphase ---
+
+static inline int CellCoord(float v, float invCellSize) {
+    return (int)floorf(v * invCellSize);
+}
+
+static inline int CellHash(int x, int y, int z, int mask) {
+    uint32_t h = (uint32_t)x * 73856093u ^ (uint32_t)y * 19349663u ^ (uint32_t)z * 83492791u;
+    return (int)(h & (uint32_t)mask);
+}
+
+// Whether a pair can produce a useful contact: at least one body must be movable and
+// awake.
+static inline int PairIsLive(const ContactSolver* s, int a, int b) {
+    if (s->asleep[a] && s->asleep[b]) {
+        return 0;
+    }
+    return s->invMass[a] > 0.0f || s->invMass[b] > 0.0f;
+}
+
+int ContactSolver_FindContacts(ContactSolver* solver, int hasGround, float groundHeight) {
+    int n = solver->bodyCount;
+    solver->contactCount = 0;
+    solver->colorCount = 0;
+    if (n == 0) {
+        return 0;
+    }
+
+    // Cells as wide as the largest body, so overlapping bodies are in adjacent cells.
+    float maxRadius = 0.0f;
+    for (int i = 0; i < n; i++) {
+        if (solver->radius[i] > maxRadius) {
+            maxRadius = solver->radius[i];
+        }
+    }
+    if (maxRadius <= 0.0f) {
+        return 0;
+    }
+    float invCellSize = 1.0f / (2.0f * maxRadius);
+
+    int cellCount = 1;
+    while (cellCount < 2 * n) {
+        cellCount *= 2;
+    }
+    if (cellCount > solver->cellCount) {
+        int* grown = realloc(solver->cellHead, (size_t)cellCount * sizeof(int));
+        if (!grown) {
+            return -1;
+        }
+        solver->cellHead = grown;
+        solver->cellCount = cellCount;
+    }
+    int mask = cellCount - 1;
+    memset(solver->cellHead, -1, (size_t)cellCount * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        int cell = CellHash(CellCoord(solver->px[i], invCellSize), CellCoord(solver->py[i], invCellSize),
+            CellCoord(solver->pz[i], invCellSize), mask);
+        solver->nextInCell[i] = solver->cellHead[cell];
+        solver->cellHead[cell] = i;
+    }
+
+    // Only awake bodies search their neighbourhood, so the cost follows the number of
+    // awake bodies. A pair of awake bodies is found from the lower index; a pair with a
+    // sleeping body is found from the awake one.
+    for (int i = 0; i < n; i++) {
+        if (solver->asleep[i]) {
+            continue;
+        }
+        float px = solver->px[i], py = solver->py[i], pz = solver->pz[i], r = solver->radius[i];
+        int cx = CellCoord(px, invCellSize), cy = CellCoord(py, invCellSize), cz = CellCoord(pz, invCellSize);
+
+        // Neighbouring cells can hash to the same bucket; visit each bucket once.
+        int buckets[27];
+        int bucketCount = 0;
+        for (int dz = -1; dz <= 1; dz++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    int cell = CellHash(cx + dx, cy + dy, cz + dz, mask);
+                    int seen = 0;
+                    for (int k = 0; k < bucketCount; k++) {
+                        if (buckets[k] == cell) {
+                            seen = 1;
+                            break;
+                        }
+                    }
+                    if (!seen) {
+                        buckets[bucketCount++] = cell;
+                    }
+                }
+            }
+        }
+
+        for (int k = 0; k < bucketCount; k++) {
+            for (int j = solver->cellHead[buckets[k]]; j != -1; j = solver->nextInCell[j]) {
+                if (j == i || (j < i && !solver->asleep[j]) || !PairIsLive(solver, i, j)) {
+                    continue;
+                }
+                float dx = solver->px[j] - px, dy = solver->py[j] - py, dz = solver->pz[j] - pz;
+                float reach = r + solver->radius[j];
+                float distSq = dx * dx + dy * dy + dz * dz;
+                if (distSq >= reach * reach) {
+                    continue;
+                }
+                float dist = sqrtf(distSq);
+                float nx = 0.0f, ny = 1.0f, nz = 0.0f; // Coincident centers: push apart vertically.
+                if (dist > 1e-6f) {
+                    float inv = 1.0f / dist;
+                    nx = dx * inv; ny = dy * inv; nz = dz * inv;
+                }
+                if (ContactSolver_AddContact(solver, i, j, nx, ny, nz, reach - dist) != 0) {
+                    return -1;
+                }
+            }
+        }
+
+        if (hasGround && solver->invMass[i] > 0.0f) {
+            float penetration = groundHeight - (py - r);
+            if (penetration > -solver->slop) {
+                if (ContactSolver_AddContact(solver, i, -1, 0.0f, -1.0f, 0.0f, penetration) != 0) {
+                    return -1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// --- Coloring ---
+
+static inline int LowestFreeColor(uint32_t used) {
+    if (used == 0xFFFFFFFFu) {
+        return SOLVER_OVERFLOW_COLOR;
+    }
+    int color = 0;
+    while (used & (1u << color)) {
+        color++;
+    }
+    return color;
+}
+
+int ContactSolver_Color(ContactSolver* solver, float dt) {
+    int count = solver->contactCount;
+    if (count > solver->coloredCapacity) {
+        int capacity = NextCapacity(solver->coloredCapacity, count);
+        SolverArray arrays[] = {
+            { (void**)&solver->bodyA, sizeof(int) }, { (void**)&solver->bodyB, sizeof(int) },
+            { (void**)&solver->nx, sizeof(float) }, { (void**)&solver->ny, sizeof(float) },
+            { (void**)&solver->nz, sizeof(float) }, { (void**)&solver->target, sizeof(float) },
+            { (void**)&solver->effectiveMass, sizeof(float) }, { (void**)&solver->impulse, sizeof(float) },
+        };
+        if (GrowArrays(arrays, (int)(sizeof(arrays) / sizeof(arrays[0])), capacity) != 0) {
+            return -1;
+        }
+        solver->coloredCapacity = capacity;
+    }
+
+    // Greedy coloring: each contact takes the lowest color neither of its movable
+    // bodies already uses.
+    int colorSize[SOLVER_MAX_COLORS + 1] = { 0 };
+    memset(solver->colorMask, 0, (size_t)solver->bodyCount * sizeof(uint32_t));
+    for (int i = 0; i < count; i++) {
+        const SolverContact* c = &solver->contacts[i];
+        int movableA = solver->invMass[c->bodyA] > 0.0f;
+        int movableB = c->bodyB >= 0 && solver->invMass[c->bodyB] > 0.0f;
+        uint32_t used = (movableA ? solver->colorMask[c->bodyA] : 0u) |
+            (movableB ? solver->colorMask[c->bodyB] : 0u);
+        int color = LowestFreeColor(used);
+        if (color != SOLVER_OVERFLOW_COLOR) {
+            if (movableA) solver->colorMask[c->bodyA] |= 1u << color;
+            if (movableB) solver->colorMask[c->bodyB] |= 1u << color;
+        }
+        solver->contactColor[i] = (uint8_t)color;
+        colorSize[color]++;
+    }
+
+    int offset = 0;
+    solver->colorCount = 0;
+    for (int color = 0; color <= SOLVER_OVERFLOW_COLOR; color++) {
+        solver->colorStart[color] = offset;
+        offset += colorSize[color];
+        if (colorSize[color] > 0) {
+            solver->colorCount = color + 1;
+        }
+    }
+    solver->colorStart[SOLVER_OVERFLOW_COLOR + 1] = offset;
+
+    // Scatter into color order, precomputing what the iterations need.
+    for (int i = 0; i < count; i++) {
+        const SolverContact* c = &solver->contacts[i];
+        int dst = solver->colorStart[solver->contactColor[i]] + --colorSize[solver->contactColor[i]];
+        float invMassSum = solver->invMass[c->bodyA] + (c->bodyB >= 0 ? solver->invMass[c->bodyB] : 0.0f);
+        float correction = c->penetration - solver->slop;
+        float contactDt = 0.0f;
+        if (solver->invMass[c->bodyA] > 0.0f) {
+            contactDt = solver->dt[c->bodyA] > 0.0f ? solver->dt[c->bodyA] : dt;
+        }
+        if (c->bodyB >= 0 && solver->invMass[c->bodyB] > 0.0f) {
+            float dtB = solver->dt[c->bodyB] > 0.0f ? solver->dt[c->bodyB] : dt;
+            if (dtB > contactDt) {
+                contactDt = dtB;
+            }
+        }
+        if (contactDt <= 0.0f) {
+            contactDt = dt;
+        }
+        float biasFactor = contactDt > 0.0f ? solver->baumgarte / contactDt : 0.0f;
+        solver->bodyA[dst] = c->bodyA;
+        solver->bodyB[dst] = c->bodyB;
+        solver->nx[dst] = c->nx;
+        solver->ny[dst] = c->ny;
+        solver->nz[dst] = c->nz;
+        solver->target[dst] = correction > 0.0f ? correction * biasFactor : 0.0f;
+        solver->effectiveMass[dst] = invMassSum > 0.0f ? 1.0f / invMassSum : 0.0f;
+        solver->impulse[dst] = 0.0f;
+    }
+    return 0;
+}
+
+// --- Solve ---
+
+// One contact: push the relative normal velocity toward the target separation speed,
+// keeping the accumulated impulse non-negative.
+static inline void SolveContact(ContactSolver* s, int c) {
+    int a = s->bodyA[c], b = s->bodyB[c];
+    float nx = s->nx[c], ny = s->ny[c], nz = s->nz[c];
+    float ima = s->invMass[a];
+    float imb = b >= 0 ? s->invMass[b] : 0.0f;
+    float vbx = 0.0f, vby = 0.0f, vbz = 0.0f;
+    if (b >= 0) {
+        vbx = s->vx[b]; vby = s->vy[b]; vbz = s->vz[b];
+    }
+    float relative = (vbx - s->vx[a]) * nx + (vby - s->vy[a]) * ny + (vbz - s->vz[a]) * nz;
+    float lambda = (s->target[c] - relative) * s->effectiveMass[c];
+    float total = s->impulse[c] + lambda;
+    if (total < 0.0f) {
+        total = 0.0f;
+    }
+    lambda = total - s->impulse[c];
+    s->impulse[c] = total;
+    if (ima > 0.0f) {
+        s->vx[a] -= nx * lambda * ima; s->vy[a] -= ny * lambda * ima; s->vz[a] -= nz * lambda * ima;
+    }
+    if (imb > 0.0f) {
+        s->vx[b] += nx * lambda * imb; s->vy[b] += ny * lambda * imb; s->vz[b] += nz * lambda * imb;
+    }
+}
+
+#ifdef MATH3D_SSE
+// Four contacts of one color at once. No two of them share a movable body, so the
+// gathered velocities are independent and the scatter cannot collide.
+static void SolveContactLanes(ContactSolver* s, int c) {
+    MATH3D_ALIGN(16) float vax[4], vay[4], vaz[4], vbx[4], vby[4], vbz[4], ima[4], imb[4];
+    for (int k = 0; k < SOLVER_LANES; k++) {
+        int a = s->bodyA[c + k], b = s->bodyB[c + k];
+        vax[k] = s->vx[a]; vay[k] = s->vy[a]; vaz[k] = s->vz[a];
+        ima[k] = s->invMass[a];
+        if (b >= 0) {
+            vbx[k] = s->vx[b]; vby[k] = s->vy[b]; vbz[k] = s->vz[b];
+            imb[k] = s->invMass[b];
+        }
+        else {
+            vbx[k] = vby[k] = vbz[k] = imb[k] = 0.0f;
+        }
+    }
+
+    __m128 nx = _mm_loadu_ps(&s->nx[c]);
+    __m128 ny = _mm_loadu_ps(&s->ny[c]);
+    __m128 nz = _mm_loadu_ps(&s->nz[c]);
+    __m128 ax = _mm_load_ps(vax), ay = _mm_load_ps(vay), az = _mm_load_ps(vaz);
+    __m128 bx = _mm_load_ps(vbx), by = _mm_load_ps(vby), bz = _mm_load_ps(vbz);
+
+    __m128 relative = _mm_add_ps(_mm_add_ps(
+        _mm_mul_ps(_mm_sub_ps(bx, ax), nx),
+        _mm_mul_ps(_mm_sub_ps(by, ay), ny)),
+        _mm_mul_ps(_mm_sub_ps(bz, az), nz));
+    __m128 lambda = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&s->target[c]), relative),
+        _mm_loadu_ps(&s->effectiveMass[c]));
+    __m128 old = _mm_loadu_ps(&s->impulse[c]);
+    __m128 total = _mm_max_ps(_mm_add_ps(old, lambda), _mm_setzero_ps());
+    _mm_storeu_ps(&s->impulse[c], total);
+    lambda = _mm_sub_ps(total, old);
+
+    __m128 la = _mm_mul_ps(lambda, _mm_load_ps(ima));
+    __m128 lb = _mm_mul_ps(lambda, _mm_load_ps(imb));
+    _mm_store_ps(vax, _mm_sub_ps(ax, _mm_mul_ps(nx, la)));
+    _mm_store_ps(vay, _mm_sub_ps(ay, _mm_mul_ps(ny, la)));
+    _mm_store_ps(vaz, _mm_sub_ps(az, _mm_mul_ps(nz, la)));
+    _mm_store_ps(vbx, _mm_add_ps(bx, _mm_mul_ps(nx, lb)));
+    _mm_store_ps(vby, _mm_add_ps(by, _mm_mul_ps(ny, lb)));
+    _mm_store_ps(vbz, _mm_add_ps(bz, _mm_mul_ps(nz, lb)));
+
+    for (int k = 0; k < SOLVER_LANES; k++) {
+        int a = s->bodyA[c + k], b = s->bodyB[c + k];
+        if (ima[k] > 0.0f) {
+            s->vx[a] = vax[k]; s->vy[a] = vay[k]; s->vz[a] = vaz[k];
+        }
+        if (imb[k] > 0.0f) {
+            s->vx[b] = vbx[k]; s->vy[b] = vby[k]; s->vz[b] = vbz[k];
+        }
+    }
+}
+#else
+static void SolveContactLanes(ContactSolver* s, int c) {
+    for (int k = 0; k < SOLVER_LANES; k++) {
+        SolveContact(s, c + k);
+    }
+}
+#endif
+
+// Parallel-for over the lane groups of one color.
+typedef struct {
+    ContactSolver* solver;
+    int first;
+    int end;
+} SolverBatch;
+
+static void SolveBatchJob(void* userData, int begin, int end) {
+    SolverBatch* batch = (SolverBatch*)userData;
+    int c = batch->first + begin * SOLVER_LANES;
+    int last = batch->first + end * SOLVER_LANES;
+    if (last > batch->end) {
+        last = batch->end;
+    }
+    for (; c + SOLVER_LANES <= last; c += SOLVER_LANES) {
+        SolveContactLanes(batch->solver, c);
+    }
+    for (; c < last; c++) {
+        SolveContact(batch->solver, c);
+    }
+}
+
+void ContactSolver_Solve(ContactSolver* solver) {
+    int threads = JobSystem_GetThreadCount(solver->jobs);
+    for (int iteration = 0; iteration < solver->iterations; iteration++) {
+        for (int color = 0; color < solver->colorCount; color++) {
+            SolverBatch batch = { solver, solver->colorStart[color], solver->colorStart[color + 1] };
+            int count = batch.end - batch.first;
+            if (count == 0) {
+                continue;
+            }
+            if (color == SOLVER_OVERFLOW_COLOR) {
+                // Contacts in the overflow batch may share bodies.
+                for (int c = batch.first; c < batch.end; c++) {
+                    SolveContact(solver, c);
+                }
+                continue;
+            }
+            int groups = (count + SOLVER_LANES - 1) / SOLVER_LANES;
+            int grain = groups / (threads * 4);
+            if (grain < SOLVER_GROUPS_PER_CHUNK) {
+                grain = SOLVER_GROUPS_PER_CHUNK;
+            }
+            JobSystem_ParallelFor(solver->jobs, groups, grain, SolveBatchJob, &batch);
+        }
+    }
+}
+
+int ContactSolver_Step(ContactSolver* solver, int hasGround, float groundHeight, float dt) {
+    if (ContactSolver_FindContacts(solver, hasGround, groundHeight) != 0) {
+        return -1;
+    }
+    if (ContactSolver_Color(solver, dt) != 0) {
+        return -1;
+    }
+    ContactSolver_Solve(solver);
+    return 0;
+}
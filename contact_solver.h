@@ -0,0 +1,89 @@
+#ifndef CONTACT_SOLVER_H
+#define CONTACT_SOLVER_H
+
+#include <stdint.h>
+#include "job_system.h"
+
+// Contacts are greedily colored so that no two contacts of one color share a dynamic
+// body; each color is then solved in parallel, four contacts per SIMD lane group.
+// Contacts that need more than SOLVER_MAX_COLORS colors go into a final overflow
+// batch that is solved serially.
+#define SOLVER_MAX_COLORS 32
+#define SOLVER_LANES 4
+
+// A contact as generated, before coloring.
+typedef struct SolverContact {
+    int bodyA;
+    int bodyB;            // -1 for a static contact (the ground).
+    float nx, ny, nz;     // Normal pointing from A to B.
+    float penetration;
+} SolverContact;
+
+// Bodies are spheres with no rotation. Bodies with invMass 0 are never written, so
+// they don't constrain the coloring.
+typedef struct ContactSolver {
+    // Bodies, structure of arrays. Callers fill these after ContactSolver_SetBodyCount.
+    int bodyCount;
+    int bodyCapacity;
+    float* px; float* py; float* pz;
+    float* vx; float* vy; float* vz;
+    float* invMass;       // 0 makes a body immovable.
+    float* radius;
+    float* dt;            // Time the body moves for after this step; 0 uses the step's dt.
+    uint8_t* asleep;      // Contacts between two sleeping bodies are skipped.
+
+    // Generated contacts, in discovery order.
+    SolverContact* contacts;
+    int contactCount;
+    int contactCapacity;
+
+    // Colored contacts, structure of arrays, filled by ContactSolver_Color.
+    int coloredCapacity;
+    int* bodyA; int* bodyB;
+    float* nx; float* ny; float* nz;
+    float* target;        // Separating velocity the solver drives toward.
+    float* effectiveMass;
+    float* impulse;       // Accumulated normal impulse.
+    int colorCount;       // Colors used, including the overflow batch if non-empty.
+    int colorStart[SOLVER_MAX_COLORS + 2];
+
+    // Broadphase grid (hashed) and coloring scratch.
+    int* cellHead;
+    int cellCount;
+    int* nextInCell;
+    uint32_t* colorMask;
+    uint8_t* contactColor;
+
+    int iterations;
+    float baumgarte;      // Fraction of penetration resolved per step.
+    float slop;           // Penetration allowed without correction.
+    JobSystem* jobs;      // Optional; colors are solved in parallel when set.
+} ContactSolver;
+
+// Returns 0 on success.
+int ContactSolver_Init(ContactSolver* solver, JobSystem* jobs);
+void ContactSolver_Shutdown(ContactSolver* solver);
+
+// Size the body arrays for this step. Returns 0 on success.
+int ContactSolver_SetBodyCount(ContactSolver* solver, int bodyCount);
+
+// Find sphere-sphere contacts with a hashed grid, plus contacts with an optional
+// ground plane. Replaces the current contact list. Returns 0 on success.
+int ContactSolver_FindContacts(ContactSolver* solver, int hasGround, float groundHeight);
+
+// Append one contact. Returns 0 on success.
+int ContactSolver_AddContact(ContactSolver* solver, int a, int b, float nx, float ny, float nz,
+    float penetration);
+
+// Partition the contacts into independent batches. Penetration is corrected over the
+// longer dt of a contact's movable bodies, so a body that moves for several frames'
+// worth of time doesn't overshoot. Returns 0 on success.
+int ContactSolver_Color(ContactSolver* solver, float dt);
+
+// Run the velocity iterations over the colored contacts.
+void ContactSolver_Solve(ContactSolver* solver);
+
+// FindContacts, Color and Solve in one call. Returns 0 on success.
+int ContactSolver_Step(ContactSolver* solver, int hasGround, float groundHeight, float dt);
+
+#endif // CONTACT_SOLVER_H
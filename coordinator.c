@@ -10,6 +10,12 @@ void Coordinator_Init(Coordinator* coordinator,
     coordinator->entityManager = entityManager;
     coordinator->componentManager = componentManager;
     coordinator->systemManager = systemManager;
+    coordinator->arena = NULL;
+    coordinator->modules = NULL;
+    for (int i = 0; i < TAG_COUNT; i++) {
+        coordinator->tagBitsets[i] = NULL;
+    }
+    coordinator->parentLinks = NULL;
 }
 
 // Create a new entity using the Entity Manager.
@@ -17,11 +23,125 @@ Entity Coordinator_CreateEntity(Coordinator* coordinator) {
     return EntityManager_CreateEntity(coordinator->entityManager);
 }
 
+static ParentComponentArray* GetParentArray(Coordinator* coordinator) {
+    IComponentArray* base = coordinator->componentManager->componentArrays[COMPONENT_PARENT];
+    assert(base && "Parent component array not registered.");
+    return (ParentComponentArray*)base;
+}
+
+static void LinkChild(ParentLinks* links, Entity child, Entity parent) {
+    int first = links->firstChild[parent];
+    links->prevSibling[child] = -1;
+    links->nextSibling[child] = first;
+    if (first != -1) {
+        links->prevSibling[first] = (int)child;
+    }
+    links->firstChild[parent] = (int)child;
+}
+
+static void UnlinkChild(ParentLinks* links, Entity child, Entity parent) {
+    int prev = links->prevSibling[child];
+    int next = links->nextSibling[child];
+    if (prev != -1) {
+        links->nextSibling[prev] = next;
+    }
+    else {
+        links->firstChild[parent] = next;
+    }
+    if (next != -1) {
+        links->prevSibling[next] = prev;
+    }
+}
+
+// Detach every child of a parent that is about to go away, so none is left pointing
+// at an ID that may be reused.
+static void DetachChildren(Coordinator* coordinator, Entity entity) {
+    if (coordinator->parentLinks) {
+        while (coordinator->parentLinks->firstChild[entity] != -1) {
+            Coordinator_RemoveParent(coordinator, (Entity)coordinator->parentLinks->firstChild[entity]);
+        }
+        return;
+    }
+    ParentComponentArray* parentArray = GetParentArray(coordinator);
+    // Backwards, since removal moves the last component into the freed slot.
+    for (size_t i = parentArray->size; i-- > 0;) {
+        if (parentArray->components[i].parent == entity) {
+            Coordinator_RemoveParent(coordinator, parentArray->indexToEntityMap[i]);
+        }
+    }
+}
+
 // Destroy an entity and notify all managers.
 void Coordinator_DestroyEntity(Coordinator* coordinator, Entity entity) {
+    if (coordinator->componentManager->componentArrays[COMPONENT_PARENT]) {
+        DetachChildren(coordinator, entity);
+        ParentComponentArray* parentArray = GetParentArray(coordinator);
+        if (coordinator->parentLinks && parentArray->entityToIndexMap[entity] != -1) {
+            UnlinkChild(coordinator->parentLinks, entity, ParentComponentArray_GetData(parentArray, entity)->parent);
+        }
+    }
+    for (int i = 0; i < TAG_COUNT; i++) {
+        if (coordinator->tagBitsets[i]) {
+            TagBitset_Clear(coordinator->tagBitsets[i], entity);
+        }
+    }
+    // Systems first, so their removal hooks can still read the components.
+    SystemManager_EntityDestroyed(coordinator->systemManager, entity);
     EntityManager_DestroyEntity(coordinator->entityManager, entity);
     ComponentManager_EntityDestroyed(coordinator->componentManager, entity);
-    SystemManager_EntityDestroyed(coordinator->systemManager, entity);
+}
+
+// --- Tag Functions ---
+
+// Mirror a tag into a bitset from now on, filled in from the current signatures.
+void Coordinator_EnableTagBitset(Coordinator* coordinator, TagType tag, TagBitset* bitset) {
+    assert(tag >= TAG_FIRST && tag < TAG_END && "Not a tag type.");
+    TagBitset_Init(bitset);
+    for (Entity e = 0; e < MAX_ENTITIES; e++) {
+        if (EntityManager_GetSignature(coordinator->entityManager, e) & (1u << tag)) {
+            TagBitset_Set(bitset, e);
+        }
+    }
+    coordinator->tagBitsets[TAG_INDEX(tag)] = bitset;
+}
+
+// Add a tag to an entity. Adding a tag it already has does nothing.
+void Coordinator_AddTag(Coordinator* coordinator, Entity entity, TagType tag) {
+    assert(tag >= TAG_FIRST && tag < TAG_END && "Not a tag type.");
+    Signature signature = EntityManager_GetSignature(coordinator->entityManager, entity);
+    if (signature & (1u << tag)) {
+        return;
+    }
+    signature |= (1u << tag);
+    EntityManager_SetSignature(coordinator->entityManager, entity, signature);
+    if (coordinator->tagBitsets[TAG_INDEX(tag)]) {
+        TagBitset_Set(coordinator->tagBitsets[TAG_INDEX(tag)], entity);
+    }
+
+    // Notify systems about the signature change.
+    SystemManager_EntitySignatureChanged(coordinator->systemManager, entity, signature);
+}
+
+// Remove a tag from an entity, if it has it.
+void Coordinator_RemoveTag(Coordinator* coordinator, Entity entity, TagType tag) {
+    assert(tag >= TAG_FIRST && tag < TAG_END && "Not a tag type.");
+    Signature signature = EntityManager_GetSignature(coordinator->entityManager, entity);
+    if (!(signature & (1u << tag))) {
+        return;
+    }
+    signature &= ~(1u << tag);
+    EntityManager_SetSignature(coordinator->entityManager, entity, signature);
+    if (coordinator->tagBitsets[TAG_INDEX(tag)]) {
+        TagBitset_Clear(coordinator->tagBitsets[TAG_INDEX(tag)], entity);
+    }
+
+    // Notify systems about the signature change.
+    SystemManager_EntitySignatureChanged(coordinator->systemManager, entity, signature);
+}
+
+int Coordinator_HasTag(Coordinator* coordinator, Entity entity, TagType tag) {
+    assert(tag >= TAG_FIRST && tag < TAG_END && "Not a tag type.");
+    return (EntityManager_GetSignature(coordinator->entityManager, entity) >> tag) & 1u;
 }
 
 // --- Transform Component Functions ---
@@ -102,3 +222,70 @@ RigidBody* Coordinator_GetRigidBody(Coordinator* coordinator, Entity entity) {
     RigidBodyComponentArray* rbArray = (RigidBodyComponentArray*)base;
     return RigidBodyComponentArray_GetData(rbArray, entity);
 }
+
+// --- Parent Component Functions ---
+
+// Attach an entity to a parent; its Transform becomes derived from Parent.local.
+void Coordinator_AddParent(Coordinator* coordinator, Entity entity, Parent component) {
+    IComponentArray* base = coordinator->componentManager->componentArrays[COMPONENT_PARENT];
+    assert(base && "Parent component array not registered.");
+    assert(component.parent != entity && "Entity cannot be its own parent.");
+    ParentComponentArray* parentArray = (ParentComponentArray*)base;
+    ParentComponentArray_Insert(parentArray, entity, component);
+    if (coordinator->parentLinks) {
+        LinkChild(coordinator->parentLinks, entity, component.parent);
+    }
+
+    // Update the entity's signature.
+    Signature signature = EntityManager_GetSignature(coordinator->entityManager, entity);
+    signature |= (1 << COMPONENT_PARENT);
+    EntityManager_SetSignature(coordinator->entityManager, entity, signature);
+
+    // Notify systems about the signature change.
+    SystemManager_EntitySignatureChanged(coordinator->systemManager, entity, signature);
+}
+
+// Retrieve a pointer to the Parent component of an entity.
+Parent* Coordinator_GetParent(Coordinator* coordinator, Entity entity) {
+    IComponentArray* base = coordinator->componentManager->componentArrays[COMPONENT_PARENT];
+    assert(base && "Parent component array not registered.");
+    ParentComponentArray* parentArray = (ParentComponentArray*)base;
+    return ParentComponentArray_GetData(parentArray, entity);
+}
+
+// Detach an entity from its parent.
+void Coordinator_RemoveParent(Coordinator* coordinator, Entity entity) {
+    ParentComponentArray* parentArray = GetParentArray(coordinator);
+    if (coordinator->parentLinks) {
+        UnlinkChild(coordinator->parentLinks, entity, ParentComponentArray_GetData(parentArray, entity)->parent);
+    }
+    ParentComponentArray_RemoveData(parentArray, entity);
+
+    // Update the entity's signature.
+    Signature signature = EntityManager_GetSignature(coordinator->entityManager, entity);
+    signature &= ~(1u << COMPONENT_PARENT);
+    EntityManager_SetSignature(coordinator->entityManager, entity, signature);
+
+    // Notify systems about the signature change.
+    SystemManager_EntitySignatureChanged(coordinator->systemManager, entity, signature);
+}
+
+// Re-attach an entity. Going through remove and add lets the systems see the change.
+void Coordinator_SetParent(Coordinator* coordinator, Entity entity, Entity parent) {
+    Parent component = *Coordinator_GetParent(coordinator, entity);
+    component.parent = parent;
+    Coordinator_RemoveParent(coordinator, entity);
+    Coordinator_AddParent(coordinator, entity, component);
+}
+
+// Start maintaining child lists.
+void Coordinator_EnableParentLinks(Coordinator* coordinator, ParentLinks* links) {
+    ParentComponentArray* parentArray = GetParentArray(coordinator);
+    for (int i = 0; i < MAX_ENTITIES; i++) {
+        links->firstChild[i] = -1;
+    }
+    for (size_t i = 0; i < parentArray->size; i++) {
+        LinkChild(links, parentArray->indexToEntityMap[i], parentArray->components[i].parent);
+    }
+    coordinator->parentLinks = links;
+}
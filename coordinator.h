@@ -10,12 +10,20 @@
 #include "rigid_body_component.h"
 #include "gravity_component.h"
 #include "physics_component.h"
+#include "parent_component.h"
+#include "arena.h"
+#include "module.h"
+#include "tags.h"
 
 // The Coordinator bundles all the managers.
 typedef struct {
     EntityManager* entityManager;
     ComponentManager* componentManager;
     SystemManager* systemManager;
+    Arena* arena;     // World-lifetime allocations (modules, systems); may be NULL.
+    ModuleRegistry* modules;  // Where register_module adds the world's modules.
+    TagBitset* tagBitsets[TAG_COUNT];  // Optional dense bitset per tag; NULL: signature only.
+    ParentLinks* parentLinks; // Optional child lists; NULL: children are found by scanning.
 } Coordinator;
 
 // Initialization.
@@ -24,10 +32,18 @@ void Coordinator_Init(Coordinator* coordinator,
     ComponentManager* componentManager,
     SystemManager* systemManager);
 
-// Entity management.
+// Entity management. Destroying a parent detaches its children (see
+// Coordinator_RemoveParent); they stay where they are.
 Entity Coordinator_CreateEntity(Coordinator* coordinator);
 void Coordinator_DestroyEntity(Coordinator* coordinator, Entity entity);
 
+// Tags: a signature bit per entity, mirrored into the tag's bitset when it has one.
+// Systems see tag changes like component changes.
+void Coordinator_EnableTagBitset(Coordinator* coordinator, TagType tag, TagBitset* bitset);
+void Coordinator_AddTag(Coordinator* coordinator, Entity entity, TagType tag);
+void Coordinator_RemoveTag(Coordinator* coordinator, Entity entity, TagType tag);
+int Coordinator_HasTag(Coordinator* coordinator, Entity entity, TagType tag);
+
 // Transform component management.
 void Coordinator_AddTransform(Coordinator* coordinator, Entity entity, Transform component);
 Transform* Coordinator_GetTransform(Coordinator* coordinator, Entity entity);
@@ -40,5 +56,18 @@ Gravity* Coordinator_GetGravity(Coordinator* coordinator, Entity entity);
 void Coordinator_AddRigidBody(Coordinator* coordinator, Entity entity, RigidBody component);
 RigidBody* Coordinator_GetRigidBody(Coordinator* coordinator, Entity entity);
 
+// Parent component management.
+void Coordinator_AddParent(Coordinator* coordinator, Entity entity, Parent component);
+Parent* Coordinator_GetParent(Coordinator* coordinator, Entity entity);
+
+// Detach an entity from its parent. Its Transform keeps the last world transform.
+void Coordinator_RemoveParent(Coordinator* coordinator, Entity entity);
+
+// Move an entity to a different parent, keeping Parent.local.
+void Coordinator_SetParent(Coordinator* coordinator, Entity entity, Entity parent);
+
+// Keep child lists in links from now on, filled in from the current Parent components.
+void Coordinator_EnableParentLinks(Coordinator* coordinator, ParentLinks* links);
+
 
 #endif // COORDINATOR_H
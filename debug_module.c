@@ -2,33 +2,40 @@
 #include <stdlib.h>
 #include "debug_module.h"
 #include "module_interface.h"
-
-// Global pointer for the DebugSystem.
-DebugSystem* gDebugSystem = NULL;
+#include "module.h"
+#include "logger.h"
 
 // Internal function that demonstrates the debug functionality.
 static void DebugSystem_Run_Impl(DebugSystem* ds, float dt) {
     // For demonstration, print out the pointer and current entity count.
-    printf("DebugSystem_Run: ds=%p, count=%d, dt=%.3f\n", (void*)ds, ds->base.count, dt);
+    LOG_DEBUG("DebugSystem_Run: ds=%p, count=%d, dt=%.3f\n", (void*)ds, ds->base.count, dt);
 }
 
 // Initialize the DebugSystem.
 static void DebugSystem_Init(DebugSystem* ds) {
-    ds->base.count = 0;
+    ECS_System_Init(&ds->base, "Debug");
     // You can initialize additional fields here if needed.
 }
 
+// Per-frame hook used by the module scheduler; the context is the world's DebugSystem.
+static void DebugModule_Update(void* context, float dt) {
+    DebugSystem_Run((DebugSystem*)context, dt);
+}
+
+static const Module debugModule = { "Debug", NULL, DebugModule_Update, NULL, 0.0 };
+
 // Exported function to register the debug module.
 void register_module(Coordinator* coordinator) {
-    DebugSystem* debugSys = malloc(sizeof(DebugSystem));
+    // Live in the world arena when there is one.
+    DebugSystem* debugSys = coordinator->arena ? ARENA_NEW(coordinator->arena, DebugSystem) : malloc(sizeof(DebugSystem));
     if (!debugSys) {
-        fprintf(stderr, "Failed to allocate DebugSystem\n");
+        LOG_ERROR("Failed to allocate DebugSystem\n");
         return;
     }
     DebugSystem_Init(debugSys);
-    gDebugSystem = debugSys;
     SystemManager_AddSystem(coordinator->systemManager, (ECS_System*)debugSys);
-    printf("Debug module registered with ECS.\n");
+    registerModule(coordinator->modules, &debugModule, debugSys);
+    LOG_INFO("Debug module registered with ECS.\n");
 }
 
 // Function to run the debug module for demonstration.
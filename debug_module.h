@@ -10,9 +10,6 @@ typedef struct {
     // Additional debug-specific data can be added here.
 } DebugSystem;
 
-// Global pointer to the DebugSystem instance.
-extern DebugSystem* gDebugSystem;
-
 // Function prototypes.
 void register_module(Coordinator* coordinator);
 void DebugSystem_Run(DebugSystem* ds, float dt);
@@ -0,0 +1,166 @@
+#include "entity_allocator.h"
+#include <assert.h>
+
+// Push a chain of count IDs starting at first.
+static void PushBlock(EntityAllocator* allocator, int first, int count) {
+    allocator->blockSize[first] = count;
+    for (;;) {
+        uint32_t top = (uint32_t)SDL_GetAtomicInt(&allocator->top);
+        uint32_t tag = (top >> allocator->indexBits) + 1;
+        SDL_SetAtomicInt(&allocator->blockNext[first], (int)(top & allocator->indexMask));
+        uint32_t value = (tag << allocator->indexBits) | (uint32_t)(first + 1);
+        if (SDL_CompareAndSwapAtomicInt(&allocator->top, (int)top, (int)value)) {
+            return;
+        }
+    }
+}
+
+// Pop a block; returns its first ID, or -1 if the stack is empty.
+static int PopBlock(EntityAllocator* allocator) {
+    for (;;) {
+        uint32_t top = (uint32_t)SDL_GetAtomicInt(&allocator->top);
+        int first = (int)(top & allocator->indexMask) - 1;
+        if (first < 0) {
+            return -1;
+        }
+        // Another thread may pop this block first and relink it; the tag then differs
+        // and the swap fails.
+        uint32_t next = (uint32_t)SDL_GetAtomicInt(&allocator->blockNext[first]);
+        uint32_t tag = (top >> allocator->indexBits) + 1;
+        uint32_t value = (tag << allocator->indexBits) | next;
+        if (SDL_CompareAndSwapAtomicInt(&allocator->top, (int)top, (int)value)) {
+            return first;
+        }
+    }
+}
+
+void EntityAllocator_Begin(EntityAllocator* allocator, EntityManager* manager, int reserve) {
+    assert(manager->lentCount == 0 && "Manager already has an allocator open.");
+    allocator->manager = manager;
+    allocator->indexBits = 1;
+    while ((1u << allocator->indexBits) <= (uint32_t)MAX_ENTITIES) {
+        allocator->indexBits++;
+    }
+    assert(allocator->indexBits <= 24 && "MAX_ENTITIES leaves too few tag bits.");
+    allocator->indexMask = (1u << allocator->indexBits) - 1;
+    SDL_SetAtomicInt(&allocator->top, 0);
+    SDL_SetAtomicInt(&allocator->created, 0);
+    SDL_SetAtomicInt(&allocator->destroyed, 0);
+
+    int count = manager->count;
+    if (reserve > 0 && reserve < count) {
+        count = reserve;
+    }
+    // Blocks are pushed last first, so IDs come out in the manager's queue order.
+    int blocks = (count + ENTITY_BLOCK_SIZE - 1) / ENTITY_BLOCK_SIZE;
+    for (int b = blocks - 1; b >= 0; b--) {
+        int begin = b * ENTITY_BLOCK_SIZE;
+        int end = begin + ENTITY_BLOCK_SIZE < count ? begin + ENTITY_BLOCK_SIZE : count;
+        for (int i = begin; i < end; i++) {
+            Entity id = manager->availableEntities[(manager->head + i) % MAX_ENTITIES];
+            allocator->next[id] = i + 1 < end ? (int)manager->availableEntities[(manager->head + i + 1) % MAX_ENTITIES] : -1;
+        }
+        PushBlock(allocator, (int)manager->availableEntities[(manager->head + begin) % MAX_ENTITIES], end - begin);
+    }
+    manager->head = (manager->head + count) % MAX_ENTITIES;
+    manager->count -= count;
+    manager->lentCount = (uint32_t)count;
+    allocator->lent = count;
+}
+
+void EntityAllocator_End(EntityAllocator* allocator) {
+    EntityManager* manager = allocator->manager;
+    int created = SDL_GetAtomicInt(&allocator->created);
+    int destroyed = SDL_GetAtomicInt(&allocator->destroyed);
+    int remaining = allocator->lent - created + destroyed;
+    assert(manager->count + remaining <= MAX_ENTITIES && "Entity IDs were lost or duplicated.");
+
+    // Put them back in front of the queue, in stack order.
+    int head = (manager->head - remaining + MAX_ENTITIES) % MAX_ENTITIES;
+    int slot = head;
+    int returned = 0;
+    for (int first = PopBlock(allocator); first >= 0; first = PopBlock(allocator)) {
+        for (int id = first; id >= 0; id = allocator->next[id]) {
+            manager->availableEntities[slot] = (Entity)id;
+            slot = (slot + 1) % MAX_ENTITIES;
+            returned++;
+        }
+    }
+    assert(returned == remaining && "An EntityIdCache was not flushed.");
+    (void)returned;
+    manager->head = head;
+    manager->count += remaining;
+    manager->lentCount = 0;
+
+    manager->LivingEntityCount += (uint32_t)created;
+    manager->LivingEntityCount -= (uint32_t)destroyed;
+    manager->CreatedCount += (uint64_t)created;
+    manager->DestroyedCount += (uint64_t)destroyed;
+    if (manager->LivingEntityCount > manager->PeakLivingEntityCount) {
+        manager->PeakLivingEntityCount = manager->LivingEntityCount;
+    }
+    allocator->lent = 0;
+}
+
+void EntityIdCache_Init(EntityIdCache* cache, EntityAllocator* allocator) {
+    cache->allocator = allocator;
+    cache->acquired = -1;
+    cache->acquiredCount = 0;
+    cache->released = -1;
+    cache->releasedCount = 0;
+    cache->created = 0;
+    cache->destroyed = 0;
+}
+
+Entity EntityIdCache_Create(EntityIdCache* cache) {
+    EntityAllocator* allocator = cache->allocator;
+    if (cache->acquiredCount == 0) {
+        // Reuse our own destroyed IDs before touching the shared stack.
+        if (cache->releasedCount > 0) {
+            cache->acquired = cache->released;
+            cache->acquiredCount = cache->releasedCount;
+            cache->released = -1;
+            cache->releasedCount = 0;
+        }
+        else {
+            int first = PopBlock(allocator);
+            if (first < 0) {
+                return ENTITY_ALLOCATOR_EMPTY;
+            }
+            cache->acquired = first;
+            cache->acquiredCount = allocator->blockSize[first];
+        }
+    }
+    Entity entity = (Entity)cache->acquired;
+    cache->acquired = allocator->next[entity];
+    cache->acquiredCount--;
+    cache->created++;
+    return entity;
+}
+
+void EntityIdCache_Destroy(EntityIdCache* cache, Entity entity) {
+    EntityAllocator* allocator = cache->allocator;
+    assert(entity < MAX_ENTITIES && "Entity out of range.");
+    allocator->manager->signatures[entity] = 0;
+    allocator->next[entity] = cache->released;
+    cache->released = (int)entity;
+    cache->destroyed++;
+    if (++cache->releasedCount == ENTITY_BLOCK_SIZE) {
+        PushBlock(allocator, cache->released, cache->releasedCount);
+        cache->released = -1;
+        cache->releasedCount = 0;
+    }
+}
+
+void EntityIdCache_Flush(EntityIdCache* cache) {
+    EntityAllocator* allocator = cache->allocator;
+    if (cache->acquiredCount > 0) {
+        PushBlock(allocator, cache->acquired, cache->acquiredCount);
+    }
+    if (cache->releasedCount > 0) {
+        PushBlock(allocator, cache->released, cache->releasedCount);
+    }
+    SDL_AddAtomicInt(&allocator->created, cache->created);
+    SDL_AddAtomicInt(&allocator->destroyed, cache->destroyed);
+    EntityIdCache_Init(cache, allocator);
+}
@@ -0,0 +1,79 @@
+#ifndef ENTITY_ALLOCATOR_H
+#define ENTITY_ALLOCATOR_H
+
+#include <SDL3/SDL.h>
+#include <stdint.h>
+#include "entity_manager.h"
+
+// Lock-free entity ID allocation for jobs and other threads.
+//
+// EntityAllocator_Begin lends free IDs from an EntityManager to the allocator, which
+// keeps them as a lock-free stack of blocks (chains of up to ENTITY_BLOCK_SIZE IDs).
+// Each thread or job works through its own EntityIdCache: creating takes IDs from a
+// block the cache popped, destroying collects IDs into a block the cache pushes once
+// full, so most calls touch no shared state and the rest are one compare-and-swap.
+// EntityAllocator_End gives every unused ID back and brings the manager's counts up
+// to date.
+//
+// Only IDs and signatures are handled. Components and systems are not thread-safe:
+// add components to reserved entities (and use Coordinator_DestroyEntity for ones
+// that have components) on the thread that owns the world, after the jobs finish.
+//
+// The stack top packs the block's first entity with a tag that changes on every
+// push and pop, so a pop that raced with others fails instead of following a stale
+// link (ABA). The tag gets the bits the entity index does not need: 18 bits with
+// MAX_ENTITIES at 10000.
+#define ENTITY_BLOCK_SIZE 64
+
+// Returned by EntityIdCache_Create when the allocator has no IDs left.
+#define ENTITY_ALLOCATOR_EMPTY ((Entity)MAX_ENTITIES)
+
+typedef struct {
+    EntityManager* manager;
+    SDL_AtomicInt top;        // (tag << indexBits) | (first entity + 1); 0 when empty.
+    int indexBits;
+    uint32_t indexMask;
+
+    // Per entity. A block's links are only written by whoever holds the block.
+    SDL_AtomicInt blockNext[MAX_ENTITIES];   // Per first entity: next block's top value.
+    int blockSize[MAX_ENTITIES];             // Per first entity: IDs in the block.
+    int next[MAX_ENTITIES];                  // Next ID of the same block, or -1.
+
+    SDL_AtomicInt created;    // Flushed from the caches.
+    SDL_AtomicInt destroyed;
+    int lent;                 // IDs taken from the manager by Begin.
+} EntityAllocator;
+
+// One thread's (or one job's) view of the allocator. Not shared between threads.
+typedef struct {
+    EntityAllocator* allocator;
+    int acquired;             // Chain of IDs to hand out, or -1.
+    int acquiredCount;
+    int released;             // Chain of destroyed IDs not yet pushed, or -1.
+    int releasedCount;
+    int created;
+    int destroyed;
+} EntityIdCache;
+
+// Lend up to reserve free IDs of the manager (all of them if reserve <= 0). The
+// manager's own create/destroy calls must not be used until EntityAllocator_End.
+void EntityAllocator_Begin(EntityAllocator* allocator, EntityManager* manager, int reserve);
+
+// Return the unused IDs to the front of the manager's queue and update its counts.
+// Every cache must have been flushed and no thread may still be using one.
+void EntityAllocator_End(EntityAllocator* allocator);
+
+void EntityIdCache_Init(EntityIdCache* cache, EntityAllocator* allocator);
+
+// A new entity with an empty signature, or ENTITY_ALLOCATOR_EMPTY.
+Entity EntityIdCache_Create(EntityIdCache* cache);
+
+// Destroy an entity that has no components. The caller must own it: no other thread
+// may create, destroy or read it meanwhile.
+void EntityIdCache_Destroy(EntityIdCache* cache, Entity entity);
+
+// Give the cache's IDs back to the allocator and publish its counts. Call when a job
+// is done with the cache; it can be used again afterwards.
+void EntityIdCache_Flush(EntityIdCache* cache);
+
+#endif // ENTITY_ALLOCATOR_H
@@ -9,22 +9,32 @@ void EntityManager_Init(EntityManager *manager) {
     manager->tail = 0; // When the queue is full, head == tail.
     manager->count = MAX_ENTITIES;
     manager->LivingEntityCount = 0;
+    manager->PeakLivingEntityCount = 0;
+    manager->CreatedCount = 0;
+    manager->DestroyedCount = 0;
+    manager->lentCount = 0;
 }
 
 Entity EntityManager_CreateEntity(EntityManager *manager) {
 	assert(manager->LivingEntityCount < MAX_ENTITIES && "Too many entities in existence.");
 	assert(manager->count > 0 && "Ran out of available entities.");
+	assert(manager->lentCount == 0 && "IDs are lent to an EntityAllocator; create through it.");
 
 	// Take an ID from the front of the queue.
 	Entity id = manager->availableEntities[manager->head];
 	manager->head = (manager->head + 1) % MAX_ENTITIES;
 	manager->count--;
 	manager->LivingEntityCount++;
+	manager->CreatedCount++;
+	if (manager->LivingEntityCount > manager->PeakLivingEntityCount) {
+		manager->PeakLivingEntityCount = manager->LivingEntityCount;
+	}
 	return id;
 }
 
 void EntityManager_DestroyEntity(EntityManager *manager, Entity entity) {
 	assert(entity < MAX_ENTITIES && "Entity out of range.");
+	assert(manager->lentCount == 0 && "IDs are lent to an EntityAllocator; destroy through it.");
 	// Invalidate the destroyed entity's signature.
 	manager->signatures[entity] = 0;
 	// Put the destroyed ID at the back of the queue.
@@ -32,6 +42,7 @@ void EntityManager_DestroyEntity(EntityManager *manager, Entity entity) {
 	manager->tail = (manager->tail + 1) % MAX_ENTITIES;
 	manager->count++;
 	manager->LivingEntityCount--;
+	manager->DestroyedCount++;
 }
 
 void EntityManager_SetSignature(EntityManager *manager, Entity entity, Signature signature) {
@@ -6,8 +6,10 @@
 #include <stdio.h>
 #include <assert.h>
 
-// Define the maximum number of entities
+// Define the maximum number of entities (overridable at build time, see ComponentArray.h)
+#ifndef MAX_ENTITIES
 #define MAX_ENTITIES 10000
+#endif
 
 // Define an entity as an unsigned 32-bit integer
 
@@ -26,6 +28,10 @@ typedef struct
 	int count;
 	Signature signatures[MAX_ENTITIES]; // each entity has a signature
 	uint32_t LivingEntityCount;
+	uint32_t PeakLivingEntityCount; // Highest LivingEntityCount seen.
+	uint64_t CreatedCount;          // Entities created since Init.
+	uint64_t DestroyedCount;        // Entities destroyed since Init.
+	uint32_t lentCount;             // IDs lent to an open EntityAllocator (entity_allocator.h).
 } EntityManager;
 
 
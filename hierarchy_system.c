@@ -0,0 +1,174 @@
+#include "hierarchy_system.h"
+#include "logger.h"
+#include "math3d.h"
+#include <string.h>
+#include <assert.h>
+
+// world = parent * local.
+static void ComposeTransform(const Transform* parent, const Transform* local, Transform* world) {
+    Vec3 scaled = Vec3_Mul(local->position, parent->scale);
+    world->position = Vec3_Add(parent->position, Quat_RotateVec3(parent->rotation, scaled));
+    world->rotation = Quat_Normalize(Quat_Mul(parent->rotation, local->rotation));
+    world->scale = Vec3_Mul(parent->scale, local->scale);
+}
+
+void HierarchySystem_Init(HierarchySystem* hsys, ComponentManager* cm, JobSystem* jobs) {
+    ECS_System_Init(&hsys->base, "Hierarchy");
+    hsys->base.requiredSignature = (1 << COMPONENT_TRANSFORM) | (1 << COMPONENT_PARENT);
+    hsys->componentManager = cm;
+    hsys->jobs = jobs;
+    hsys->nodeCount = 0;
+    hsys->treeCount = 0;
+    hsys->builtVersion = 0;
+    hsys->structureDirty = 1;
+    for (int i = 0; i < MAX_ENTITIES; i++) {
+        hsys->nodeOfEntity[i] = -1;
+        hsys->entityDirty[i] = 0;
+    }
+}
+
+void HierarchySystem_MarkDirty(HierarchySystem* hsys, Entity entity) {
+    assert(entity < MAX_ENTITIES && "Entity out of range.");
+    int node = hsys->nodeOfEntity[entity];
+    hsys->entityDirty[entity] = 1;
+    if (node >= 0) {
+        HierarchyTree* tree = &hsys->trees[hsys->nodes[node].tree];
+        if (!tree->dirty) {
+            tree->dirty = 1;
+        }
+    }
+}
+
+// Rebuild the breadth-first node order from the Parent components.
+static void RebuildHierarchy(HierarchySystem* hsys) {
+    ParentComponentArray* parentArray =
+        (ParentComponentArray*)hsys->componentManager->componentArrays[COMPONENT_PARENT];
+    TransformComponentArray* transformArray =
+        (TransformComponentArray*)hsys->componentManager->componentArrays[COMPONENT_TRANSFORM];
+
+    for (int i = 0; i < hsys->nodeCount; i++) {
+        hsys->nodeOfEntity[hsys->nodes[i].entity] = -1;
+    }
+    for (int i = 0; i < MAX_ENTITIES; i++) {
+        hsys->firstChild[i] = -1;
+    }
+
+    // Link each member into its parent's child list. Members are marked -2 until
+    // placed, so parents that are not members can be told apart.
+    for (int i = 0; i < hsys->base.count; i++) {
+        Entity e = hsys->base.entities[i];
+        Entity p = ParentComponentArray_GetData(parentArray, e)->parent;
+        hsys->nextSibling[e] = hsys->firstChild[p];
+        hsys->firstChild[p] = (int)e;
+        hsys->nodeOfEntity[e] = -2;
+    }
+
+    // Every parent that is not itself a member (no Parent, or no Transform) roots a
+    // tree; walk it breadth-first.
+    hsys->nodeCount = 0;
+    hsys->treeCount = 0;
+    for (int i = 0; i < hsys->base.count; i++) {
+        Entity root = ParentComponentArray_GetData(parentArray, hsys->base.entities[i])->parent;
+        if (hsys->nodeOfEntity[root] != -1 || hsys->firstChild[root] == -1) {
+            continue; // Not a root, or a root already emitted.
+        }
+        int treeIndex = hsys->treeCount++;
+        HierarchyTree* tree = &hsys->trees[treeIndex];
+        tree->root = root;
+        tree->begin = hsys->nodeCount;
+        tree->dirty = 2; // New layout, so recompute the whole tree.
+        if (transformArray->entityToIndexMap[root] != -1) {
+            hsys->rootCache[root] = *TransformComponentArray_GetData(transformArray, root);
+        }
+
+        for (int c = hsys->firstChild[root]; c != -1; c = hsys->nextSibling[c]) {
+            HierarchyNode* node = &hsys->nodes[hsys->nodeCount];
+            node->entity = (Entity)c;
+            node->parentIndex = -1;
+            node->tree = treeIndex;
+            hsys->nodeOfEntity[c] = hsys->nodeCount++;
+        }
+        for (int n = tree->begin; n < hsys->nodeCount; n++) {
+            Entity e = hsys->nodes[n].entity;
+            for (int c = hsys->firstChild[e]; c != -1; c = hsys->nextSibling[c]) {
+                HierarchyNode* node = &hsys->nodes[hsys->nodeCount];
+                node->entity = (Entity)c;
+                node->parentIndex = n;
+                node->tree = treeIndex;
+                hsys->nodeOfEntity[c] = hsys->nodeCount++;
+            }
+        }
+        tree->end = hsys->nodeCount;
+        // Mark the root as emitted.
+        hsys->firstChild[root] = -1;
+    }
+
+    // Whatever was not reached hangs off a cycle of members.
+    if (hsys->nodeCount != hsys->base.count) {
+        for (int i = 0; i < hsys->base.count; i++) {
+            if (hsys->nodeOfEntity[hsys->base.entities[i]] == -2) {
+                hsys->nodeOfEntity[hsys->base.entities[i]] = -1;
+            }
+        }
+        LOG_WARN("HierarchySystem: %d entities are part of a parent cycle and are ignored\n",
+            hsys->base.count - hsys->nodeCount);
+    }
+    hsys->builtVersion = hsys->base.version;
+    hsys->structureDirty = 0;
+}
+
+// Propagate world transforms through trees [begin, end).
+static void PropagateTrees(void* userData, int begin, int end) {
+    HierarchySystem* hsys = (HierarchySystem*)userData;
+    ParentComponentArray* parentArray =
+        (ParentComponentArray*)hsys->componentManager->componentArrays[COMPONENT_PARENT];
+    TransformComponentArray* transformArray =
+        (TransformComponentArray*)hsys->componentManager->componentArrays[COMPONENT_TRANSFORM];
+    static const Transform identity = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f } };
+
+    for (int t = begin; t < end; t++) {
+        HierarchyTree* tree = &hsys->trees[t];
+
+        // A root without a Transform acts as the identity.
+        const Transform* rootWorld = &identity;
+        int rootMoved = 0;
+        if (transformArray->entityToIndexMap[tree->root] != -1) {
+            rootWorld = TransformComponentArray_GetData(transformArray, tree->root);
+            if (memcmp(rootWorld, &hsys->rootCache[tree->root], sizeof(Transform)) != 0) {
+                hsys->rootCache[tree->root] = *rootWorld;
+                rootMoved = 1;
+            }
+        }
+        if (!rootMoved && !tree->dirty) {
+            continue;
+        }
+
+        for (int n = tree->begin; n < tree->end; n++) {
+            const HierarchyNode* node = &hsys->nodes[n];
+            int parentChanged = node->parentIndex < 0 ? rootMoved : hsys->nodeChanged[node->parentIndex];
+            int changed = tree->dirty == 2 || parentChanged || hsys->entityDirty[node->entity];
+            hsys->nodeChanged[n] = (uint8_t)changed;
+            if (!changed) {
+                continue;
+            }
+            const Transform* parentWorld = node->parentIndex < 0 ? rootWorld : &hsys->nodeWorld[node->parentIndex];
+            const Parent* parent = ParentComponentArray_GetData(parentArray, node->entity);
+            ComposeTransform(parentWorld, &parent->local, &hsys->nodeWorld[n]);
+            *TransformComponentArray_GetData(transformArray, node->entity) = hsys->nodeWorld[n];
+            hsys->entityDirty[node->entity] = 0;
+        }
+        tree->dirty = 0;
+    }
+}
+
+void HierarchySystem_Update(HierarchySystem* hsys, float dt) {
+    (void)dt;
+    if (hsys->structureDirty || hsys->builtVersion != hsys->base.version) {
+        RebuildHierarchy(hsys);
+    }
+
+    // Trees are independent, so split them across the job system.
+    int threads = JobSystem_GetThreadCount(hsys->jobs);
+    int grain = hsys->treeCount / (threads * 4);
+    JobSystem_ParallelFor(hsys->jobs, hsys->treeCount, grain, PropagateTrees, hsys);
+}
@@ -0,0 +1,64 @@
+#ifndef HIERARCHY_SYSTEM_H
+#define HIERARCHY_SYSTEM_H
+
+#include "System.h"
+#include "entity_manager.h"
+#include "ComponentManager.h"
+#include "ComponentTypes.h"
+#include "TransformComponent.h"
+#include "parent_component.h"
+#include "job_system.h"
+
+// One hierarchy member, stored breadth-first so parents always precede children.
+typedef struct {
+    Entity entity;
+    int parentIndex;  // Node index of the parent, or -1 if the parent is the tree root.
+    int tree;         // Index into HierarchySystem.trees.
+} HierarchyNode;
+
+// A root entity (a parent that is not itself a member) and the contiguous node range
+// below it. A root without a Transform acts as the identity.
+typedef struct {
+    Entity root;
+    int begin;
+    int end;
+    int dirty;        // 1: some member was marked dirty, 2: recompute every node.
+} HierarchyTree;
+
+// Derives world Transforms of parented entities. Trees are laid out back to back in
+// `nodes`, each breadth-first, so a tree is one contiguous range that can be
+// propagated independently of the others.
+typedef struct {
+    ECS_System base;  // Entities with Transform + Parent.
+    ComponentManager* componentManager;
+    JobSystem* jobs;  // Optional; trees are propagated in parallel when set.
+
+    HierarchyNode nodes[MAX_ENTITIES];
+    Transform nodeWorld[MAX_ENTITIES];    // World transform per node, in node order.
+    uint8_t nodeChanged[MAX_ENTITIES];    // Recomputed during the current propagation.
+    int nodeCount;
+    HierarchyTree trees[MAX_ENTITIES];
+    int treeCount;
+
+    int nodeOfEntity[MAX_ENTITIES];       // -1 if the entity is not a hierarchy member.
+    uint8_t entityDirty[MAX_ENTITIES];    // Local transform changed since last propagation.
+    Transform rootCache[MAX_ENTITIES];    // Root world transforms seen at last propagation.
+
+    // Scratch for rebuilding the breadth-first order.
+    int firstChild[MAX_ENTITIES];
+    int nextSibling[MAX_ENTITIES];
+
+    uint32_t builtVersion;
+    int structureDirty;
+} HierarchySystem;
+
+// Initialize the system. jobs may be NULL to propagate on the calling thread.
+void HierarchySystem_Init(HierarchySystem* hsys, ComponentManager* cm, JobSystem* jobs);
+
+// Flag an entity whose Parent.local was written so its subtree is recomputed.
+void HierarchySystem_MarkDirty(HierarchySystem* hsys, Entity entity);
+
+// Recompute world transforms for dirty subtrees (and subtrees whose root moved).
+void HierarchySystem_Update(HierarchySystem* hsys, float dt);
+
+#endif // HIERARCHY_SYSTEM_H
@@ -0,0 +1,144 @@
+#include "job_system.h"
+#include "logger.h"
+#include <string.h>
+#include <assert.h>
+
+// Claim and run chunks until the batch is exhausted.
+static void RunChunks(JobSystem* js, JobFunc func, void* userData, int count, int grain) {
+    for (;;) {
+        int begin = SDL_AddAtomicInt(&js->next, grain);
+        if (begin >= count) {
+            break;
+        }
+        int end = begin + grain;
+        if (end > count) {
+            end = count;
+        }
+        func(userData, begin, end);
+    }
+}
+
+static int WorkerThread(void* data) {
+    JobSystem* js = (JobSystem*)data;
+    int seen = 0;
+
+    SDL_LockMutex(js->mutex);
+    for (;;) {
+        while (!js->quit && !(js->batchOpen && js->generation != seen)) {
+            SDL_WaitCondition(js->wake, js->mutex);
+        }
+        if (js->quit) {
+            break;
+        }
+        // Join the batch while holding the lock so the submitter can't close it under us.
+        seen = js->generation;
+        js->active++;
+        JobFunc func = js->func;
+        void* userData = js->userData;
+        int count = js->count;
+        int grain = js->grain;
+        SDL_UnlockMutex(js->mutex);
+
+        RunChunks(js, func, userData, count, grain);
+
+        SDL_LockMutex(js->mutex);
+        if (--js->active == 0) {
+            SDL_SignalCondition(js->done);
+        }
+    }
+    SDL_UnlockMutex(js->mutex);
+    return 0;
+}
+
+int JobSystem_Init(JobSystem* js, int workerCount) {
+    memset(js, 0, sizeof(*js));
+    if (workerCount < 0) {
+        workerCount = SDL_GetNumLogicalCPUCores() - 1;
+    }
+    if (workerCount > MAX_JOB_WORKERS) {
+        workerCount = MAX_JOB_WORKERS;
+    }
+
+    js->mutex = SDL_CreateMutex();
+    js->wake = SDL_CreateCondition();
+    js->done = SDL_CreateCondition();
+    if (!js->mutex || !js->wake || !js->done) {
+        LOG_ERROR("JobSystem_Init: failed to create sync objects\n");
+        JobSystem_Shutdown(js);
+        return -1;
+    }
+
+    for (int i = 0; i < workerCount; i++) {
+        js->workers[i] = SDL_CreateThread(WorkerThread, "JobWorker", js);
+        if (!js->workers[i]) {
+            LOG_WARN("JobSystem_Init: only started %d of %d workers\n", i, workerCount);
+            break;
+        }
+        js->workerCount++;
+    }
+    return 0;
+}
+
+void JobSystem_Shutdown(JobSystem* js) {
+    if (js->mutex) {
+        SDL_LockMutex(js->mutex);
+        js->quit = 1;
+        SDL_BroadcastCondition(js->wake);
+        SDL_UnlockMutex(js->mutex);
+    }
+    for (int i = 0; i < js->workerCount; i++) {
+        SDL_WaitThread(js->workers[i], NULL);
+        js->workers[i] = NULL;
+    }
+    js->workerCount = 0;
+
+    if (js->done) SDL_DestroyCondition(js->done);
+    if (js->wake) SDL_DestroyCondition(js->wake);
+    if (js->mutex) SDL_DestroyMutex(js->mutex);
+    js->done = NULL;
+    js->wake = NULL;
+    js->mutex = NULL;
+}
+
+void JobSystem_ParallelFor(JobSystem* js, int count, int grain, JobFunc func, void* userData) {
+    if (count <= 0) {
+        return;
+    }
+    if (grain < 1) {
+        grain = 1;
+    }
+    // Small ranges, no workers, or a busy pool: just run here. The busy flag is not
+    // reentrant, so a job that calls back into the pool also ends up here.
+    if (!js || js->workerCount == 0 || count <= grain || !SDL_CompareAndSwapAtomicInt(&js->busy, 0, 1)) {
+        func(userData, 0, count);
+        return;
+    }
+
+    SDL_LockMutex(js->mutex);
+    js->func = func;
+    js->userData = userData;
+    js->count = count;
+    js->grain = grain;
+    SDL_SetAtomicInt(&js->next, 0);
+    js->generation++;
+    js->batchOpen = 1;
+    SDL_BroadcastCondition(js->wake);
+    SDL_UnlockMutex(js->mutex);
+
+    RunChunks(js, func, userData, count, grain);
+
+    // Every chunk is claimed; wait for workers still finishing theirs, then close the
+    // batch so late wakers don't pick up the next one with stale parameters.
+    SDL_LockMutex(js->mutex);
+    while (js->active > 0) {
+        SDL_WaitCondition(js->done, js->mutex);
+    }
+    js->batchOpen = 0;
+    SDL_UnlockMutex(js->mutex);
+
+    SDL_SetAtomicInt(&js->busy, 0);
+}
+
+int JobSystem_GetThreadCount(const JobSystem* js) {
+    return js ? js->workerCount + 1 : 1;
+}
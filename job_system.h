@@ -0,0 +1,48 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <SDL3/SDL.h>
+
+#define MAX_JOB_WORKERS 64
+
+// Processes items [begin, end) of a parallel-for.
+typedef void (*JobFunc)(void* userData, int begin, int end);
+
+// A fixed pool of worker threads that split parallel-for ranges between them.
+// Only one parallel-for runs on the pool at a time; calls made while it is busy
+// (including nested calls from inside a job) run inline on the calling thread.
+typedef struct JobSystem {
+    SDL_Thread* workers[MAX_JOB_WORKERS];
+    int workerCount;
+    SDL_AtomicInt busy;       // Set while a thread owns the current batch.
+    SDL_Mutex* mutex;         // Guards the batch description below.
+    SDL_Condition* wake;      // Signals workers that a batch is open (or to quit).
+    SDL_Condition* done;      // Signals the submitter that the last worker left.
+
+    // Current batch.
+    JobFunc func;
+    void* userData;
+    int count;
+    int grain;
+    SDL_AtomicInt next;       // Next unclaimed item.
+    int generation;
+    int batchOpen;
+    int active;               // Workers currently inside the batch.
+    int quit;
+} JobSystem;
+
+// Start the pool. workerCount < 0 uses one worker per logical core minus the caller.
+// Returns 0 on success.
+int JobSystem_Init(JobSystem* js, int workerCount);
+
+// Stop and join all worker threads.
+void JobSystem_Shutdown(JobSystem* js);
+
+// Run func over [0, count) in chunks of grain items and wait for completion.
+// js may be NULL, in which case the range runs inline.
+void JobSystem_ParallelFor(JobSystem* js, int count, int grain, JobFunc func, void* userData);
+
+// Threads that take part in a parallel-for (workers plus the caller).
+int JobSystem_GetThreadCount(const JobSystem* js);
+
+#endif // JOB_SYSTEM_H
@@ -0,0 +1,55 @@
+#ifndef KERNEL_H
+#define KERNEL_H
+
+#include "entity_manager.h"
+
+// Fusible per-entity kernels.
+//
+// A kernel is a static inline function that works on one entity at a time and only
+// touches that entity's components (and its own context). Kernels that run over the
+// same entity list can be fused: one loop calls each kernel in turn for every entity,
+// so a component they share is pulled through the cache once per frame instead of
+// once per kernel.
+//
+// Declare kernels with ECS_KERNEL and describe what they touch with a KernelAccess.
+// ECS_PASS instantiates a loop over one kernel, ECS_FUSED_PASS2 a single loop over
+// two. Which form to run is decided at runtime with Kernel_CanFuse.
+
+// Components a kernel touches, as signature bits.
+typedef struct {
+    const char* name;
+    Signature reads;          // Read from the entity being visited.
+    Signature writes;         // Written on the entity being visited.
+    Signature readsOthers;    // Read from other entities (e.g. a parent's Transform).
+} KernelAccess;
+
+// Whether b may run right after a for each entity, instead of after a has visited
+// every entity. Fused, a kernel that reads another entity's component can see it
+// before or after the other kernel wrote it, depending on visiting order.
+static inline int Kernel_CanFuse(const KernelAccess* a, const KernelAccess* b) {
+    return (a->writes & b->readsOthers) == 0 && (b->writes & a->readsOthers) == 0;
+}
+
+// Kernel definition: ECS_KERNEL(Name, ContextType) { ... uses ctx and entity ... }
+#define ECS_KERNEL(Name, ContextType) \
+    static inline void Name(ContextType* ctx, Entity entity)
+
+// static void PassName(C1* ctx1, const Entity* entities, int count)
+#define ECS_PASS(PassName, K1, C1)                                                  \
+    static void PassName(C1* ctx1, const Entity* entities, int count) {             \
+        for (int i = 0; i < count; i++) {                                           \
+            K1(ctx1, entities[i]);                                                  \
+        }                                                                           \
+    }
+
+// static void PassName(C1* ctx1, C2* ctx2, const Entity* entities, int count)
+#define ECS_FUSED_PASS2(PassName, K1, C1, K2, C2)                                   \
+    static void PassName(C1* ctx1, C2* ctx2, const Entity* entities, int count) {   \
+        for (int i = 0; i < count; i++) {                                           \
+            Entity entity = entities[i];                                            \
+            K1(ctx1, entity);                                                       \
+            K2(ctx2, entity);                                                       \
+        }                                                                           \
+    }
+
+#endif // KERNEL_H
@@ -0,0 +1,330 @@
+#include "logger.h"
+#include <SDL3/SDL.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define LOG_RING_MASK (LOG_RING_CAPACITY - 1)
+#define LOG_SPEC_MAX 32
+
+// How an argument was pulled off the va_list, so it can be handed back to snprintf.
+typedef enum {
+    LOG_ARG_INT = 0,
+    LOG_ARG_UINT,
+    LOG_ARG_LONG,
+    LOG_ARG_ULONG,
+    LOG_ARG_LLONG,
+    LOG_ARG_ULLONG,
+    LOG_ARG_SIZE,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_PTR,
+    LOG_ARG_STR,
+} LogArgType;
+
+typedef union {
+    long long i;
+    unsigned long long u;
+    double d;
+    const void* p;
+} LogArg;
+
+// Compact binary record; formatting happens on the flusher thread.
+typedef struct {
+    const char* fmt;
+    Uint64 timestampNs;
+    uint8_t level;
+    uint8_t argCount;
+    uint8_t argTypes[LOG_MAX_ARGS];
+    LogArg args[LOG_MAX_ARGS];
+} LogRecord;
+
+// Single-producer/single-consumer ring owned by one thread at a time.
+typedef struct {
+    SDL_AtomicU32 head;      // Next slot the producer writes.
+    char pad0[60];
+    SDL_AtomicU32 tail;      // Next slot the flusher reads.
+    char pad1[60];
+    SDL_AtomicInt owned;     // Nonzero while a thread is using this ring.
+    LogRecord records[LOG_RING_CAPACITY];
+} LogRing;
+
+typedef struct {
+    LogRing* rings;          // Allocated once and kept for the life of the process.
+    SDL_AtomicInt running;
+    SDL_AtomicInt dropped;
+    SDL_Thread* flusher;
+    LogPolicy policy;
+} Logger;
+
+static Logger gLogger;
+static SDL_TLSID gLogRingTLS;
+
+static const char* const kLevelNames[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+
+// Release this thread's ring when the thread exits so another can claim it.
+static void ReleaseRing(void* value) {
+    LogRing* ring = (LogRing*)value;
+    SDL_SetAtomicInt(&ring->owned, 0);
+}
+
+static LogRing* AcquireRing(void) {
+    LogRing* ring = (LogRing*)SDL_GetTLS(&gLogRingTLS);
+    if (ring) {
+        return ring;
+    }
+    for (int i = 0; i < LOG_MAX_THREADS; i++) {
+        if (SDL_CompareAndSwapAtomicInt(&gLogger.rings[i].owned, 0, 1)) {
+            ring = &gLogger.rings[i];
+            SDL_SetTLS(&gLogRingTLS, ring, ReleaseRing);
+            return ring;
+        }
+    }
+    return NULL;
+}
+
+// Parse one conversion starting after '%'. Returns the character past it and the arg type,
+// or -1 as the type for "%%".
+static const char* ParseSpec(const char* p, int* outType) {
+    while (*p && strchr("-+ #0", *p)) p++;
+    while (*p >= '0' && *p <= '9') p++;
+    if (*p == '.') {
+        p++;
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    int longCount = 0, sizeMod = 0;
+    for (;; p++) {
+        if (*p == 'l') longCount++;
+        else if (*p == 'h') {}
+        else if (*p == 'z' || *p == 't') sizeMod = 1;
+        else if (*p == 'j') longCount = 2;
+        else break;
+    }
+    switch (*p) {
+    case '%': *outType = -1; break;
+    case 'd': case 'i': case 'c':
+        *outType = sizeMod ? LOG_ARG_SIZE : longCount == 0 ? LOG_ARG_INT : longCount == 1 ? LOG_ARG_LONG : LOG_ARG_LLONG;
+        break;
+    case 'u': case 'x': case 'X': case 'o':
+        *outType = sizeMod ? LOG_ARG_SIZE : longCount == 0 ? LOG_ARG_UINT : longCount == 1 ? LOG_ARG_ULONG : LOG_ARG_ULLONG;
+        break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        *outType = LOG_ARG_DOUBLE;
+        break;
+    case 'p': *outType = LOG_ARG_PTR; break;
+    case 's': *outType = LOG_ARG_STR; break;
+    default:
+        assert(0 && "Unsupported log conversion.");
+        *outType = -1;
+        return *p ? p + 1 : p;
+    }
+    return p + 1;
+}
+
+static int CaptureArgs(LogRecord* rec, const char* fmt, va_list ap) {
+    int count = 0;
+    for (const char* p = fmt; *p; ) {
+        if (*p++ != '%') {
+            continue;
+        }
+        int type;
+        p = ParseSpec(p, &type);
+        if (type < 0) {
+            continue;
+        }
+        assert(count < LOG_MAX_ARGS && "Too many log arguments.");
+        if (count >= LOG_MAX_ARGS) {
+            break;
+        }
+        LogArg* arg = &rec->args[count];
+        switch (type) {
+        case LOG_ARG_INT:    arg->i = va_arg(ap, int); break;
+        case LOG_ARG_UINT:   arg->u = va_arg(ap, unsigned int); break;
+        case LOG_ARG_LONG:   arg->i = va_arg(ap, long); break;
+        case LOG_ARG_ULONG:  arg->u = va_arg(ap, unsigned long); break;
+        case LOG_ARG_LLONG:  arg->i = va_arg(ap, long long); break;
+        case LOG_ARG_ULLONG: arg->u = va_arg(ap, unsigned long long); break;
+        case LOG_ARG_SIZE:   arg->u = va_arg(ap, size_t); break;
+        case LOG_ARG_DOUBLE: arg->d = va_arg(ap, double); break;
+        default:             arg->p = va_arg(ap, const void*); break;
+        }
+        rec->argTypes[count++] = (uint8_t)type;
+    }
+    return count;
+}
+
+// Expand a record back into text using the captured arguments.
+static void FormatRecord(const LogRecord* rec, FILE* out) {
+    char line[1024];
+    size_t len = (size_t)snprintf(line, sizeof(line), "[%8.3f] %-5s ",
+        (double)rec->timestampNs / 1e9, kLevelNames[rec->level]);
+    int argIndex = 0;
+
+    for (const char* p = rec->fmt; *p && len < sizeof(line) - 1; ) {
+        if (*p != '%') {
+            line[len++] = *p++;
+            continue;
+        }
+        int type;
+        const char* end = ParseSpec(p + 1, &type);
+        if (type < 0) {
+            line[len++] = '%';
+            p = end;
+            continue;
+        }
+        char spec[LOG_SPEC_MAX];
+        size_t specLen = (size_t)(end - p);
+        if (specLen >= sizeof(spec) || argIndex >= rec->argCount) {
+            break;
+        }
+        memcpy(spec, p, specLen);
+        spec[specLen] = '\0';
+        const LogArg* arg = &rec->args[argIndex++];
+        char* dst = line + len;
+        size_t room = sizeof(line) - len;
+        int written;
+        switch (type) {
+        case LOG_ARG_INT:    written = snprintf(dst, room, spec, (int)arg->i); break;
+        case LOG_ARG_UINT:   written = snprintf(dst, room, spec, (unsigned int)arg->u); break;
+        case LOG_ARG_LONG:   written = snprintf(dst, room, spec, (long)arg->i); break;
+        case LOG_ARG_ULONG:  written = snprintf(dst, room, spec, (unsigned long)arg->u); break;
+        case LOG_ARG_LLONG:  written = snprintf(dst, room, spec, (long long)arg->i); break;
+        case LOG_ARG_ULLONG: written = snprintf(dst, room, spec, (unsigned long long)arg->u); break;
+        case LOG_ARG_SIZE:   written = snprintf(dst, room, spec, (size_t)arg->u); break;
+        case LOG_ARG_DOUBLE: written = snprintf(dst, room, spec, arg->d); break;
+        case LOG_ARG_STR:    written = snprintf(dst, room, spec, (const char*)arg->p); break;
+        default:             written = snprintf(dst, room, spec, arg->p); break;
+        }
+        if (written > 0) {
+            len += ((size_t)written < room) ? (size_t)written : room - 1;
+        }
+        p = end;
+    }
+    if (len > sizeof(line) - 1) {
+        len = sizeof(line) - 1;
+    }
+    line[len] = '\0';
+    fputs(line, out);
+}
+
+// Format and write everything currently queued. Returns the number of records written.
+static int DrainRings(void) {
+    int drained = 0;
+    for (int i = 0; i < LOG_MAX_THREADS; i++) {
+        LogRing* ring = &gLogger.rings[i];
+        Uint32 tail = SDL_GetAtomicU32(&ring->tail);
+        Uint32 head = SDL_GetAtomicU32(&ring->head);
+        SDL_MemoryBarrierAcquire();
+        while (tail != head) {
+            const LogRecord* rec = &ring->records[tail & LOG_RING_MASK];
+            FormatRecord(rec, rec->level >= LOG_LEVEL_WARN ? stderr : stdout);
+            tail++;
+            drained++;
+        }
+        SDL_SetAtomicU32(&ring->tail, tail);
+    }
+    if (drained) {
+        fflush(stdout);
+        fflush(stderr);
+    }
+    return drained;
+}
+
+static int FlusherThread(void* data) {
+    (void)data;
+    while (SDL_GetAtomicInt(&gLogger.running)) {
+        if (DrainRings() == 0) {
+            SDL_DelayNS(500000);
+        }
+    }
+    DrainRings();
+    return 0;
+}
+
+void Logger_Init(LogPolicy policy) {
+    if (SDL_GetAtomicInt(&gLogger.running)) {
+        return;
+    }
+    if (!gLogger.rings) {
+        gLogger.rings = (LogRing*)calloc(LOG_MAX_THREADS, sizeof(LogRing));
+        if (!gLogger.rings) {
+            fprintf(stderr, "Failed to allocate log rings\n");
+            return;
+        }
+    }
+    gLogger.policy = policy;
+    SDL_SetAtomicInt(&gLogger.dropped, 0);
+    SDL_SetAtomicInt(&gLogger.running, 1);
+    gLogger.flusher = SDL_CreateThread(FlusherThread, "LogFlusher", NULL);
+    if (!gLogger.flusher) {
+        fprintf(stderr, "Failed to start log flusher: %s\n", SDL_GetError());
+        SDL_SetAtomicInt(&gLogger.running, 0);
+    }
+}
+
+void Logger_Shutdown(void) {
+    if (!SDL_GetAtomicInt(&gLogger.running)) {
+        return;
+    }
+    SDL_SetAtomicInt(&gLogger.running, 0);
+    SDL_WaitThread(gLogger.flusher, NULL);
+    gLogger.flusher = NULL;
+}
+
+void Logger_Write(LogLevel level, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+
+    if (!SDL_GetAtomicInt(&gLogger.running)) {
+        // No flusher yet: fall back to writing synchronously.
+        FILE* out = level >= LOG_LEVEL_WARN ? stderr : stdout;
+        vfprintf(out, fmt, ap);
+        va_end(ap);
+        return;
+    }
+
+    LogRing* ring = AcquireRing();
+    if (!ring) {
+        SDL_AddAtomicInt(&gLogger.dropped, 1);
+        va_end(ap);
+        return;
+    }
+
+    Uint32 head = SDL_GetAtomicU32(&ring->head);
+    while (head - SDL_GetAtomicU32(&ring->tail) >= LOG_RING_CAPACITY) {
+        if (gLogger.policy == LOG_POLICY_DROP) {
+            SDL_AddAtomicInt(&gLogger.dropped, 1);
+            va_end(ap);
+            return;
+        }
+        SDL_DelayNS(100000);
+    }
+
+    LogRecord* rec = &ring->records[head & LOG_RING_MASK];
+    rec->fmt = fmt;
+    rec->timestampNs = SDL_GetTicksNS();
+    rec->level = (uint8_t)level;
+    rec->argCount = (uint8_t)CaptureArgs(rec, fmt, ap);
+    va_end(ap);
+
+    SDL_MemoryBarrierRelease();
+    SDL_SetAtomicU32(&ring->head, head + 1);
+}
+
+void Logger_Flush(void) {
+    if (!SDL_GetAtomicInt(&gLogger.running)) {
+        return;
+    }
+    for (int i = 0; i < LOG_MAX_THREADS; i++) {
+        LogRing* ring = &gLogger.rings[i];
+        Uint32 head = SDL_GetAtomicU32(&ring->head);
+        while ((int)(head - SDL_GetAtomicU32(&ring->tail)) > 0) {
+            SDL_DelayNS(100000);
+        }
+    }
+}
+
+uint32_t Logger_GetDroppedCount(void) {
+    return (uint32_t)SDL_GetAtomicInt(&gLogger.dropped);
+}
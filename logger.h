@@ -0,0 +1,49 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdint.h>
+
+// Asynchronous logger. Log calls copy the format pointer and raw arguments into a
+// per-thread lock-free ring; a background thread formats and writes them out.
+//
+// Format strings and any %s arguments must outlive the flush (string literals,
+// module names, ...) since only their pointers are recorded.
+
+#define LOG_MAX_ARGS 6
+#define LOG_MAX_THREADS 64
+#define LOG_RING_CAPACITY 1024 // Records per thread; must be a power of two.
+
+typedef enum {
+    LOG_LEVEL_DEBUG = 0,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR,
+} LogLevel;
+
+// What a producer does when its ring is full.
+typedef enum {
+    LOG_POLICY_DROP = 0, // Discard the record and count it as dropped.
+    LOG_POLICY_BLOCK,    // Wait for the flusher to make room.
+} LogPolicy;
+
+// Start the flusher thread. Before this is called, log calls print synchronously.
+void Logger_Init(LogPolicy policy);
+
+// Drain every ring and stop the flusher thread.
+void Logger_Shutdown(void);
+
+// Record a message. Supports the integer, floating point, %p and %s conversions.
+void Logger_Write(LogLevel level, const char* fmt, ...);
+
+// Block until everything recorded so far has been written.
+void Logger_Flush(void);
+
+// Number of records discarded because a ring was full (or no ring was free).
+uint32_t Logger_GetDroppedCount(void);
+
+#define LOG_DEBUG(...) Logger_Write(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...)  Logger_Write(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARN(...)  Logger_Write(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_ERROR(...) Logger_Write(LOG_LEVEL_ERROR, __VA_ARGS__)
+
+#endif // LOGGER_H
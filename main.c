@@ -1,189 +1,526 @@
 #include <SDL3/SDL.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <time.h>
-#include "coordinator.h"
-#include "entity_manager.h"
-#include "ComponentManager.h"
-#include "system_manager.h"
-#include "ComponentTypes.h"
-#include "TransformComponent.h"
-#include "gravity_component.h"
-#include "rigid_body_component.h"
-#include "physics_system.h"
-#include "Components.h"
+#include "job_system.h"
 #include "render3d_system.h"
-#include "module_interface.h"
-#include "debug_module.h"
+#include "soft_raster.h"
+#include "logger.h"
+#include "benchmark.h"
+#include "world.h"
+#include "world_batch.h"
+#include "sim_pipeline.h"
+#include "replay.h"
+#include "telemetry.h"
+#include "world_stream.h"
+#include "perf_suite.h"
+
+// Run several independent worlds side by side and report how each ended up. World i
+// gets gravity scaled by (1 + i / count), as a small parameter sweep.
+static int RunWorldBatch(int worldCount, int frames, uint32_t seed, JobSystem* jobs) {
+    World* worlds = malloc(sizeof(World) * (size_t)worldCount);
+    World** worldPtrs = malloc(sizeof(World*) * (size_t)worldCount);
+    if (!worlds || !worldPtrs) {
+        free(worlds);
+        free(worldPtrs);
+        return 1;
+    }
+    int created = 0;
+    for (; created < worldCount; created++) {
+        WorldConfig config;
+        WorldConfig_Default(&config);
+        config.jobs = jobs;
+        config.seed = seed + (uint32_t)created;
+        config.gravity.y *= 1.0f + (float)created / (float)worldCount;
+        config.loadModules = 0;
+        if (World_Init(&worlds[created], &config) != 0) {
+            break;
+        }
+        World_SpawnFallingBlocks(&worlds[created], 200);
+        worldPtrs[created] = &worlds[created];
+    }
+
+    int result = 0;
+    if (created == worldCount) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        WorldBatch_Run(worldPtrs, worldCount, frames, 0.016f, jobs);
+        double ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+
+        printf("%d worlds x %d frames in %.1f ms (%.1f world-frames/s, %d threads)\n",
+            worldCount, frames, ms, ms > 0.0 ? worldCount * frames * 1000.0 / ms : 0.0, JobSystem_GetThreadCount(jobs));
+        for (int i = 0; i < worldCount; i++) {
+            World* world = &worlds[i];
+            float meanY = 0.0f;
+            for (int k = 0; k < world->physicsSystem->base.count; k++) {
+                meanY += TransformComponentArray_GetData(world->transformArray, world->physicsSystem->base.entities[k])->position.y;
+            }
+            if (world->physicsSystem->base.count > 0) {
+                meanY /= (float)world->physicsSystem->base.count;
+            }
+            printf("  world %2d: gravity %6.2f, %3d of %d bodies awake, mean height %8.2f\n",
+                i, world->gravity.y, world->physicsSystem->activeCount, world->physicsSystem->base.count, meanY);
+        }
+    }
+    else {
+        fprintf(stderr, "Failed to create world %d\n", created);
+        result = 1;
+    }
 
-
-// Global so render3d_system.c can use it
-SDL_Color entityColors[MAX_ENTITIES];
-
-int main(void) {
-    // --- Initialize ECS Managers ---
-    EntityManager* entityManager = malloc(sizeof(EntityManager));
-    if (!entityManager) return 1;
-    EntityManager_Init(entityManager);
-
-    ComponentManager* componentManager = malloc(sizeof(ComponentManager));
-    if (!componentManager) return 1;
-    for (int i = 0; i < MAX_COMPONENT_TYPES; i++) {
-        componentManager->componentArrays[i] = NULL;
-    }
-
-    SystemManager* systemManager = malloc(sizeof(SystemManager));
-    if (!systemManager) return 1;
-    systemManager->count = 0;
-
-    // Register component arrays
-    TransformComponentArray* transformArray = malloc(sizeof(TransformComponentArray));
-    if (!transformArray) return 1;
-    TransformComponentArray_Init(transformArray);
-    ComponentManager_RegisterComponent(componentManager, COMPONENT_TRANSFORM, (IComponentArray*)transformArray);
-
-    GravityComponentArray* gravityArray = malloc(sizeof(GravityComponentArray));
-    if (!gravityArray) return 1;
-    GravityComponentArray_Init(gravityArray);
-    ComponentManager_RegisterComponent(componentManager, COMPONENT_GRAVITY, (IComponentArray*)gravityArray);
-
-    RigidBodyComponentArray* rigidBodyArray = malloc(sizeof(RigidBodyComponentArray));
-    if (!rigidBodyArray) return 1;
-    RigidBodyComponentArray_Init(rigidBodyArray);
-    ComponentManager_RegisterComponent(componentManager, COMPONENT_RIGID_BODY, (IComponentArray*)rigidBodyArray);
-
-    // --- Register Systems ---
-    PhysicsSystem* physicsSystem = malloc(sizeof(PhysicsSystem));
-    if (!physicsSystem) return 1;
-    PhysicsSystem_Init(physicsSystem, componentManager);
-    SystemManager_AddSystem(systemManager, (ECS_System*)physicsSystem);
-
-    Render3DSystem render3dSystem;
-    Render3DSystem_Init(&render3dSystem, componentManager);
-    SystemManager_AddSystem(systemManager, (ECS_System*)&render3dSystem);
-
-    // Initialize the coordinator
-    Coordinator coordinator;
-    Coordinator_Init(&coordinator, entityManager, componentManager, systemManager);
-
-    // Register Modules (such as debug module)
-    register_module(&coordinator);
-
-    // Set up randomization
-    srand((unsigned)time(NULL));
-    int numEntities = 200;
-
-    // Create entities with wide random positions, random rotations, negative Y gravity
-    for (int i = 0; i < numEntities; i++) {
-        Entity entity = Coordinator_CreateEntity(&coordinator);
-
-        // Spread them out more in X and Y
-        float randPosX = ((float)rand() / RAND_MAX) * 300.0f - 150.0f;
-        float randPosY = ((float)rand() / RAND_MAX) * 300.0f - 150.0f;
-        float randPosZ = ((float)rand() / RAND_MAX) * 100.0f + 50.0f; 
-
-        // Random 3-axis rotation
-        float randRotX = ((float)rand() / RAND_MAX) * 6.283185f;  // 0..2?
-        float randRotY = ((float)rand() / RAND_MAX) * 6.283185f;
-        float randRotZ = ((float)rand() / RAND_MAX) * 6.283185f;
-
-        
-        float scale = 5.0f;
-
-        // Gravity downward along Y
-        Gravity g = { { 0.0f, -9.8f, 0.0f } };
-
-        // No initial velocity
-        RigidBody rb = { {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f} };
-
-        // Transform has position, rotation, scale
-        Transform t = {
-            { randPosX, randPosY, randPosZ },
-            { randRotX, randRotY, randRotZ },
-            { scale, scale, scale }
-        };
-
-        // Assign random color
-        entityColors[entity].r = rand() % 256;
-        entityColors[entity].g = rand() % 256;
-        entityColors[entity].b = rand() % 256;
-        entityColors[entity].a = 255;
-
-        Coordinator_AddGravity(&coordinator, entity, g);
-        Coordinator_AddRigidBody(&coordinator, entity, rb);
-        Coordinator_AddTransform(&coordinator, entity, t);
-    }
-
-    // ---- Initialize SDL3 ----
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        fprintf(stderr, "SDL_Init Error: %s\n", SDL_GetError());
+    for (int i = 0; i < created; i++) {
+        World_Destroy(&worlds[i]);
+    }
+    free(worldPtrs);
+    free(worlds);
+    return result;
+}
+
+// Apply an input to the world and, when recording, add it to the log.
+static void ApplyInput(World* world, ReplayLog* record, uint8_t type, Vec3 value) {
+    InputEvent input = { world->frame, type, 0, value };
+    World_ApplyInput(world, &input);
+    if (record && ReplayLog_AddInput(record, &input) != 0) {
+        LOG_ERROR("Replay: failed to record input for frame %u\n", input.frame);
+    }
+}
+
+// Re-simulate a recorded session headless and compare checksums frame by frame.
+static int RunReplay(const char* path, JobSystem* jobs) {
+    ReplayLog log;
+    if (ReplayLog_Load(&log, path) != 0) {
+        fprintf(stderr, "Failed to load replay %s\n", path);
         return 1;
     }
+    ReplayResult result;
+    int status = Replay_Play(&log, jobs, 0, &result);
+    if (status != 0) {
+        fprintf(stderr, "Failed to create the replay world\n");
+    }
+    else if (result.firstMismatch >= 0) {
+        printf("Replay %s diverged at frame %d (expected %08x, got %08x)\n",
+            path, result.firstMismatch, result.expected, result.actual);
+        status = 1;
+    }
+    else {
+        printf("Replay %s: %d frames, %d inputs, seed %u, all checksums match (%.1f ms, %.0f frames/s)\n",
+            path, result.framesPlayed, log.inputCount, log.seed, result.totalMs,
+            result.totalMs > 0.0 ? result.framesPlayed * 1000.0 / result.totalMs : 0.0);
+    }
+    ReplayLog_Free(&log);
+    return status;
+}
 
-    SDL_Window* window = SDL_CreateWindow("Falling Blocks Demo", 1280, 720, 0);
-    if (!window) {
-        fprintf(stderr, "SDL_CreateWindow Error: %s\n", SDL_GetError());
-        SDL_Quit();
+int main(int argc, char** argv) {
+    // --- Command line ---
+    // --headless          Render with the software rasterizer instead of a window.
+    // --frames N          Number of frames to run (default 1001).
+    // --dump PREFIX       Headless only: write PREFIX_<frame>.ppm snapshots.
+    // --dump-interval N   Frames between snapshots (default 100).
+    // --bench NAME        Run a benchmark and exit ("--bench list" shows them).
+    // --worlds N          Step N independent worlds over the job pool and exit.
+    // --serial            Simulate and render on one thread instead of pipelining.
+    // --seed N            World seed (default: the current time).
+    // --record PATH       Record inputs and per-frame checksums to a replay file.
+    // --replay PATH       Re-simulate a replay file headless, verify it and exit.
+    // --kick-interval N   Kick every body upward every N frames (space does it by hand).
+    // --stats N           Log ECS storage and occupancy stats every N frames.
+    // --stats-csv PATH    Write those stats as CSV instead of logging them.
+    // --perf              Run the performance regression suite against a baseline and exit.
+    // --perf-only NAME    Run one scenario ("--perf-only list" shows them).
+    // --perf-baseline P   Baseline file (default perf_baseline.txt).
+    // --perf-tolerance F  Allowed slowdown as a fraction (default 0.25).
+    // --perf-update       Write the results to the baseline instead of comparing.
+    // --lod               Tick physics bodies far from the camera less often.
+    // --stream DIR        Stream cells of the world out to DIR and back as a focus
+    //                     point sweeps across it (DIR must exist).
+    int headless = 0;
+    int maxFrames = 1001;
+    const char* dumpPrefix = NULL;
+    int dumpInterval = 100;
+    const char* benchName = NULL;
+    int worldCount = 0;
+    int serial = 0;
+    uint32_t seed = (uint32_t)time(NULL);
+    const char* recordPath = NULL;
+    const char* replayPath = NULL;
+    int kickInterval = 0;
+    int statsInterval = 0;
+    const char* statsCsvPath = NULL;
+    const char* streamDir = NULL;
+    int updateLod = 0;
+    int perf = 0;
+    PerfSuiteConfig perfConfig;
+    PerfSuiteConfig_Default(&perfConfig, NULL);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            headless = 1;
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            maxFrames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            dumpPrefix = argv[++i];
+        }
+        else if (strcmp(argv[i], "--dump-interval") == 0 && i + 1 < argc) {
+            dumpInterval = atoi(argv[++i]);
+            if (dumpInterval < 1) dumpInterval = 1;
+        }
+        else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+            benchName = argv[++i];
+        }
+        else if (strcmp(argv[i], "--worlds") == 0 && i + 1 < argc) {
+            worldCount = atoi(argv[++i]);
+            if (worldCount < 1) worldCount = 1;
+        }
+        else if (strcmp(argv[i], "--serial") == 0) {
+            serial = 1;
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--kick-interval") == 0 && i + 1 < argc) {
+            kickInterval = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+            statsInterval = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--stats-csv") == 0 && i + 1 < argc) {
+            statsCsvPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--perf") == 0) {
+            perf = 1;
+        }
+        else if (strcmp(argv[i], "--perf-only") == 0 && i + 1 < argc) {
+            perf = 1;
+            perfConfig.only = argv[++i];
+        }
+        else if (strcmp(argv[i], "--perf-baseline") == 0 && i + 1 < argc) {
+            perfConfig.baselinePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--perf-tolerance") == 0 && i + 1 < argc) {
+            perfConfig.tolerance = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--perf-update") == 0) {
+            perf = 1;
+            perfConfig.updateBaseline = 1;
+        }
+        else if (strcmp(argv[i], "--lod") == 0) {
+            updateLod = 1;
+        }
+        else if (strcmp(argv[i], "--stream") == 0 && i + 1 < argc) {
+            streamDir = argv[++i];
+        }
+        else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (streamDir && recordPath) {
+        // Streaming changes the world outside World_ApplyInput, so a replay would diverge.
+        fprintf(stderr, "--stream cannot be combined with --record\n");
+        return 1;
+    }
+    if (updateLod && recordPath) {
+        // Replays are re-simulated without LOD.
+        fprintf(stderr, "--lod cannot be combined with --record\n");
         return 1;
     }
 
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, "opengl");
-    if (!renderer) {
-        fprintf(stderr, "SDL_CreateRenderer Error: %s\n", SDL_GetError());
-        SDL_DestroyWindow(window);
-        SDL_Quit();
+    // Start the async logger first so modules never print on the simulation thread.
+    Logger_Init(LOG_POLICY_DROP);
+    atexit(Logger_Shutdown);
+
+    if (benchName) {
+        if (strcmp(benchName, "list") == 0) {
+            Benchmark_List();
+            return 0;
+        }
+        JobSystem benchJobs;
+        if (JobSystem_Init(&benchJobs, -1) != 0) return 1;
+        int result = Benchmark_Run(benchName, &benchJobs);
+        JobSystem_Shutdown(&benchJobs);
+        return result;
+    }
+
+    // Worker threads shared by systems that split their work.
+    JobSystem jobSystem;
+    if (JobSystem_Init(&jobSystem, -1) != 0) return 1;
+
+    if (perf) {
+        if (perfConfig.only && strcmp(perfConfig.only, "list") == 0) {
+            PerfSuite_List();
+            JobSystem_Shutdown(&jobSystem);
+            return 0;
+        }
+        perfConfig.jobs = &jobSystem;
+        int result = PerfSuite_Run(&perfConfig);
+        JobSystem_Shutdown(&jobSystem);
+        return result;
+    }
+
+    if (replayPath) {
+        int result = RunReplay(replayPath, &jobSystem);
+        JobSystem_Shutdown(&jobSystem);
+        return result;
+    }
+
+    if (worldCount > 0) {
+        int result = RunWorldBatch(worldCount, maxFrames, seed, &jobSystem);
+        JobSystem_Shutdown(&jobSystem);
+        return result;
+    }
+
+    // --- Create the world ---
+    WorldConfig worldConfig;
+    WorldConfig_Default(&worldConfig);
+    worldConfig.arenaFlags = ARENA_HUGE_PAGES;
+    worldConfig.jobs = &jobSystem;
+    worldConfig.seed = seed;
+    worldConfig.updateLod = updateLod;
+    World* world = malloc(sizeof(World));
+    if (!world || World_Init(world, &worldConfig) != 0) {
+        fprintf(stderr, "Failed to create the world\n");
         return 1;
     }
+    // Periodic storage stats; set up before spawning so the spawn counts as churn.
+    FILE* statsCsv = NULL;
+    if (statsCsvPath) {
+        statsCsv = fopen(statsCsvPath, "w");
+        if (!statsCsv) {
+            fprintf(stderr, "Failed to open %s\n", statsCsvPath);
+            return 1;
+        }
+        Telemetry_WriteCsvHeader(statsCsv);
+        if (statsInterval < 1) statsInterval = 60;
+    }
+    if (statsInterval > 0) {
+        Telemetry_Init(&world->telemetry, &world->coordinator, statsInterval,
+            statsCsv ? Telemetry_CsvSink : Telemetry_LogSink, statsCsv);
+    }
+
+    const int spawnCount = 200;
+    World_SpawnFallingBlocks(world, spawnCount);
+    LOG_INFO("World seed %u.\n", seed);
+
+    // ---- Initialize the render backend ----
+    const int screenWidth = 1280;
+    const int screenHeight = 720;
+    SDL_Window* window = NULL;
+    SDL_Renderer* renderer = NULL;
+    SoftRaster* raster = NULL;
+
+    if (headless) {
+        // Software rasterizer into memory; no display or GPU needed.
+        raster = ARENA_NEW(&world->arena, SoftRaster);
+        if (!raster || SoftRaster_Init(raster, screenWidth, screenHeight, &jobSystem) != 0) {
+            fprintf(stderr, "Failed to create the software rasterizer\n");
+            return 1;
+        }
+    }
+    else {
+        if (!SDL_Init(SDL_INIT_VIDEO)) {
+            fprintf(stderr, "SDL_Init Error: %s\n", SDL_GetError());
+            return 1;
+        }
+
+        window = SDL_CreateWindow("Falling Blocks Demo", screenWidth, screenHeight, 0);
+        if (!window) {
+            fprintf(stderr, "SDL_CreateWindow Error: %s\n", SDL_GetError());
+            SDL_Quit();
+            return 1;
+        }
+
+        renderer = SDL_CreateRenderer(window, "opengl");
+        if (!renderer) {
+            fprintf(stderr, "SDL_CreateRenderer Error: %s\n", SDL_GetError());
+            SDL_DestroyWindow(window);
+            SDL_Quit();
+            return 1;
+        }
+    }
+    Render3DTarget renderTarget = { renderer, raster, screenWidth, screenHeight };
 
     // Main loop
     int quit = 0;
     SDL_Event event;
-    float dt = 0.016f; // ~60 FPS
+    float dt = 0.016f; // ~60 FPS, fixed so runs are reproducible
     int iterations = 0;
+    double renderMs = 0.0;
+    double simMs = 0.0;
+    double frameMs = 0.0;
+    long long renderTriangles = 0;
+
+    // Pipelined: frame N+1 simulates on its own thread while frame N renders from a
+    // snapshot. The first frame is simulated up front so there is something to draw.
+    // When recording, every input applied and the checksum after every step go to the
+    // log. Inputs are only applied while no step is running.
+    ReplayLog replayLog;
+    ReplayLog* record = NULL;
+    if (recordPath) {
+        ReplayLog_Init(&replayLog, seed, dt, (uint32_t)spawnCount);
+        record = &replayLog;
+    }
 
+    SimPipeline pipeline;
+    if (!serial) {
+        if (SimPipeline_Start(&pipeline, world) != 0) return 1;
+        SimPipeline_Kick(&pipeline, dt);
+        SimPipeline_Wait(&pipeline);
+        if (record) ReplayLog_AddChecksum(record, World_Checksum(world));
+    }
+
+    WorldStream stream;
+    if (streamDir) {
+        WorldStreamConfig streamConfig;
+        WorldStreamConfig_Default(&streamConfig, streamDir);
+        if (WorldStream_Start(&stream, world, &streamConfig) != 0) return 1;
+    }
+
+    const Vec3 kick = { 0.0f, 8.0f, 0.0f };
     while (!quit) {
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_EVENT_QUIT) {
-                quit = 1;
+        if (!headless) {
+            while (SDL_PollEvent(&event)) {
+                if (event.type == SDL_EVENT_QUIT) {
+                    quit = 1;
+                }
+                else if (event.type == SDL_EVENT_KEY_DOWN && event.key.key == SDLK_SPACE && !event.key.repeat) {
+                    ApplyInput(world, record, INPUT_KICK, kick);
+                }
             }
         }
+        if (kickInterval > 0 && iterations > 0 && iterations % kickInterval == 0) {
+            ApplyInput(world, record, INPUT_KICK, kick);
+        }
+        if (streamDir) {
+            // The focus sweeps from side to side; cells far from it leave memory.
+            Vec3 focus = { 150.0f * sinf((float)iterations * dt * 0.5f), 0.0f, 100.0f };
+            WorldStream_Update(&stream, focus);
+        }
 
-        // Update physics
-        PhysicsSystem_Update(physicsSystem, dt);
-
-
-        // Clear screen
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderClear(renderer);
+        Uint64 frameStart = SDL_GetPerformanceCounter();
 
-        // Render 3D cubes
-        Render3DSystem_Update(&render3dSystem, dt, renderer, 1280, 720);
+        // Physics, hierarchy and modules.
+        if (serial) {
+            World_Step(world, dt);
+            simMs += (double)(SDL_GetPerformanceCounter() - frameStart) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+            if (record) ReplayLog_AddChecksum(record, World_Checksum(world));
+        }
+        else {
+            SimPipeline_Kick(&pipeline, dt);
+        }
 
-        // Demonstrate the Debug module purpose.
-        if (gDebugSystem) {
-            DebugSystem_Run(gDebugSystem, dt);
+        // Clear screen and render 3D cubes
+        Uint64 renderStart = SDL_GetPerformanceCounter();
+        if (raster) {
+            SDL_Color clearColor = { 0, 0, 0, 255 };
+            SoftRaster_BeginFrame(raster, clearColor);
+        }
+        else {
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+            SDL_RenderClear(renderer);
+        }
+        if (serial) {
+            World_Render(world, &renderTarget);
+        }
+        else {
+            World_RenderSnapshot(world, &renderTarget);
+        }
+        if (raster) {
+            SoftRaster_EndFrame(raster);
+        }
+        renderTriangles += world->render3dSystem->trianglesSubmitted;
+        renderMs += (double)(SDL_GetPerformanceCounter() - renderStart) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+
+        if (raster) {
+            // Headless runs go as fast as possible; optionally dump frames.
+            if (dumpPrefix && iterations % dumpInterval == 0) {
+                char path[512];
+                snprintf(path, sizeof(path), "%s_%05d.ppm", dumpPrefix, iterations);
+                if (SoftRaster_WritePPM(raster, path) != 0) {
+                    fprintf(stderr, "Failed to write %s\n", path);
+                }
+            }
+        }
+        else {
+            SDL_RenderPresent(renderer);
         }
 
-        SDL_RenderPresent(renderer);
-        SDL_Delay(16);
+        if (!serial) {
+            SimPipeline_Wait(&pipeline);
+            simMs += pipeline.lastStepMs;
+            if (record) ReplayLog_AddChecksum(record, World_Checksum(world));
+        }
+        frameMs += (double)(SDL_GetPerformanceCounter() - frameStart) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+        if (!headless) {
+            SDL_Delay(16);
+        }
 
         iterations++;
-        if (iterations > 1000)
+        if (iterations >= maxFrames)
             quit = 1;
     }
 
+    LOG_INFO("World arena: %zu of %zu bytes used%s, frame scratch high water %zu bytes.\n",
+        world->arena.highWater, world->arena.size, world->arena.hugePages ? " (huge pages)" : "", world->frameScratch.highWater);
+    LOG_INFO("%d of %d physics bodies awake at exit.\n", world->physicsSystem->activeCount, world->physicsSystem->base.count);
+    LOG_INFO("Rendered %d frames, %.3f ms average render time, %lld triangles per frame.\n",
+        iterations, iterations ? renderMs / iterations : 0.0, iterations ? renderTriangles / iterations : 0LL);
+    LOG_INFO("%s: %.3f ms average frame, %.3f ms average simulation step.\n",
+        serial ? "Serial" : "Pipelined", iterations ? frameMs / iterations : 0.0, iterations ? simMs / iterations : 0.0);
+
+    if (world->updateLod) {
+        const UpdateLod* lod = world->updateLod;
+        LOG_INFO("Update LOD: %.1f of %.1f bodies ticked per frame, %u rebuilds.\n",
+            lod->frame ? (double)lod->ticks / (double)lod->frame : 0.0,
+            lod->frame ? (double)lod->memberFrames / (double)lod->frame : 0.0, lod->rebuilds);
+    }
+    if (streamDir) {
+        WorldStream_Stop(&stream);
+        LOG_INFO("Streaming: %d cells resident, %d on disk, %d unloads and %d loads.\n",
+            WorldStream_CountCells(&stream, STREAM_CELL_RESIDENT), WorldStream_CountCells(&stream, STREAM_CELL_ON_DISK),
+            stream.cellsUnloaded, stream.cellsLoaded);
+        LOG_INFO("Streaming: %lld bytes written, %lld read, %.3f ms worst update, %u entities alive.\n",
+            stream.bytesWritten, stream.bytesRead, stream.worstUpdateMs, world->entityManager->LivingEntityCount);
+    }
+
+    if (record) {
+        if (ReplayLog_Save(record, recordPath) == 0) {
+            LOG_INFO("Recorded %d frames and %d inputs to %s.\n", record->frameCount, record->inputCount, recordPath);
+        }
+        else {
+            LOG_ERROR("Failed to write replay %s\n", recordPath);
+        }
+        ReplayLog_Free(record);
+    }
+
     // Cleanup
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
-    SDL_Quit();
-
-    free(physicsSystem);
-    free(rigidBodyArray);
-    free(gravityArray);
-    free(transformArray);
-    free(systemManager);
-    free(componentManager);
-    free(entityManager);
+    if (!serial) {
+        SimPipeline_Stop(&pipeline);
+    }
+    if (raster) {
+        SoftRaster_Shutdown(raster);
+    }
+    else {
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+    }
+
+    World_Destroy(world);
+    free(world);
+    JobSystem_Shutdown(&jobSystem);
+    if (statsCsv) {
+        fclose(statsCsv);
+    }
 
+    LOG_INFO("Dropped %u log messages.\n", Logger_GetDroppedCount());
     return 0;
 }
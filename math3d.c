@@ -0,0 +1,103 @@
+#include "math3d.h"
+
+// Fill out[0..count) from the rotation/scale/translation in SoA form.
+static void StoreAffine(Mat3x4* out, int count,
+    const float m[9][4], const float* sx, const float* sy, const float* sz,
+    const float* tx, const float* ty, const float* tz)
+{
+    for (int i = 0; i < count; i++) {
+        out[i].row[0] = Vec4f_Set(m[0][i] * sx[i], m[1][i] * sy[i], m[2][i] * sz[i], tx[i]);
+        out[i].row[1] = Vec4f_Set(m[3][i] * sx[i], m[4][i] * sy[i], m[5][i] * sz[i], ty[i]);
+        out[i].row[2] = Vec4f_Set(m[6][i] * sx[i], m[7][i] * sy[i], m[8][i] * sz[i], tz[i]);
+    }
+}
+
+// Rotation matrix elements for four quaternions given in SoA form.
+static void QuatToMatrix4(const float* qx, const float* qy, const float* qz, const float* qw, float m[9][4]) {
+#ifdef MATH3D_SSE
+    __m128 x = _mm_loadu_ps(qx), y = _mm_loadu_ps(qy), z = _mm_loadu_ps(qz), w = _mm_loadu_ps(qw);
+    __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f);
+    __m128 x2 = _mm_mul_ps(x, two), y2 = _mm_mul_ps(y, two), z2 = _mm_mul_ps(z, two);
+    __m128 xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2);
+    __m128 xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2);
+    __m128 wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2);
+    _mm_storeu_ps(m[0], _mm_sub_ps(one, _mm_add_ps(yy, zz)));
+    _mm_storeu_ps(m[1], _mm_sub_ps(xy, wz));
+    _mm_storeu_ps(m[2], _mm_add_ps(xz, wy));
+    _mm_storeu_ps(m[3], _mm_add_ps(xy, wz));
+    _mm_storeu_ps(m[4], _mm_sub_ps(one, _mm_add_ps(xx, zz)));
+    _mm_storeu_ps(m[5], _mm_sub_ps(yz, wx));
+    _mm_storeu_ps(m[6], _mm_sub_ps(xz, wy));
+    _mm_storeu_ps(m[7], _mm_add_ps(yz, wx));
+    _mm_storeu_ps(m[8], _mm_sub_ps(one, _mm_add_ps(xx, yy)));
+#else
+    for (int i = 0; i < 4; i++) {
+        float x = qx[i], y = qy[i], z = qz[i], w = qw[i];
+        m[0][i] = 1.0f - 2.0f * (y * y + z * z);
+        m[1][i] = 2.0f * (x * y - w * z);
+        m[2][i] = 2.0f * (x * z + w * y);
+        m[3][i] = 2.0f * (x * y + w * z);
+        m[4][i] = 1.0f - 2.0f * (x * x + z * z);
+        m[5][i] = 2.0f * (y * z - w * x);
+        m[6][i] = 2.0f * (x * z - w * y);
+        m[7][i] = 2.0f * (y * z + w * x);
+        m[8][i] = 1.0f - 2.0f * (x * x + y * y);
+    }
+#endif
+}
+
+Mat3x4 Mat3x4_FromTransform(const Transform* t) {
+    Mat3x4 out;
+    Math3D_TransformToMat3x4Batch(t, &out, 1);
+    return out;
+}
+
+void Math3D_QuatToMat3x4Batch(const Quat* q, Mat3x4* out, int n) {
+    static const float ones[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    static const float zeros[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (int base = 0; base < n; base += 4) {
+        int count = (n - base < 4) ? n - base : 4;
+        float qx[4] = { 0 }, qy[4] = { 0 }, qz[4] = { 0 }, qw[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        for (int i = 0; i < count; i++) {
+            qx[i] = q[base + i].x; qy[i] = q[base + i].y; qz[i] = q[base + i].z; qw[i] = q[base + i].w;
+        }
+        float m[9][4];
+        QuatToMatrix4(qx, qy, qz, qw, m);
+        StoreAffine(out + base, count, m, ones, ones, ones, zeros, zeros, zeros);
+    }
+}
+
+void Math3D_TransformToMat3x4Batch(const Transform* t, Mat3x4* out, int n) {
+    for (int base = 0; base < n; base += 4) {
+        int count = (n - base < 4) ? n - base : 4;
+        float qx[4] = { 0 }, qy[4] = { 0 }, qz[4] = { 0 }, qw[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        float sx[4], sy[4], sz[4], tx[4], ty[4], tz[4];
+        for (int i = 0; i < count; i++) {
+            const Transform* tr = &t[base + i];
+            qx[i] = tr->rotation.x; qy[i] = tr->rotation.y; qz[i] = tr->rotation.z; qw[i] = tr->rotation.w;
+            sx[i] = tr->scale.x; sy[i] = tr->scale.y; sz[i] = tr->scale.z;
+            tx[i] = tr->position.x; ty[i] = tr->position.y; tz[i] = tr->position.z;
+        }
+        float m[9][4];
+        QuatToMatrix4(qx, qy, qz, qw, m);
+        StoreAffine(out + base, count, m, sx, sy, sz, tx, ty, tz);
+    }
+}
+
+void Math3D_TransformPoints(const Mat4* m, const Vec3* in, Vec3* out, int n) {
+#ifdef MATH3D_SSE
+    __m128 c0 = m->col[0].v, c1 = m->col[1].v, c2 = m->col[2].v, c3 = m->col[3].v;
+    for (int i = 0; i < n; i++) {
+        __m128 r = _mm_add_ps(c3, _mm_mul_ps(c0, _mm_set1_ps(in[i].x)));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(in[i].y)));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(in[i].z)));
+        Vec4f v;
+        v.v = r;
+        out[i] = Vec4f_ToVec3(v);
+    }
+#else
+    for (int i = 0; i < n; i++) {
+        out[i] = Mat4_TransformPoint(m, in[i]);
+    }
+#endif
+}
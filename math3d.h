@@ -0,0 +1,264 @@
+#ifndef MATH3D_H
+#define MATH3D_H
+
+// Shared vector, quaternion and matrix math. Vec3/Quat (components.h) are the packed
+// storage types used by components; Vec4f, Mat4 and Mat3x4 are 16-byte aligned
+// SIMD types used for computation. SSE2 is used when available, scalar otherwise.
+
+#include <math.h>
+#include "components.h"
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATH3D_SSE 1
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#define MATH3D_ALIGN(n) __declspec(align(n))
+#else
+#define MATH3D_ALIGN(n) __attribute__((aligned(n)))
+#endif
+
+typedef MATH3D_ALIGN(16) union Vec4f {
+    float f[4];
+#ifdef MATH3D_SSE
+    __m128 v;
+#endif
+} Vec4f;
+
+// Column-major 4x4 matrix: p' = col[0]*x + col[1]*y + col[2]*z + col[3].
+typedef MATH3D_ALIGN(16) struct Mat4 {
+    Vec4f col[4];
+} Mat4;
+
+// Row-major affine matrix: row r is (r0, r1, r2, translation_r).
+typedef MATH3D_ALIGN(16) struct Mat3x4 {
+    Vec4f row[3];
+} Mat3x4;
+
+// --- Vec3 (storage type) ---
+
+static inline Vec3 Vec3_Make(float x, float y, float z) {
+    Vec3 r = { x, y, z };
+    return r;
+}
+
+static inline Vec3 Vec3_Add(Vec3 a, Vec3 b) {
+    Vec3 r = { a.x + b.x, a.y + b.y, a.z + b.z };
+    return r;
+}
+
+static inline Vec3 Vec3_Sub(Vec3 a, Vec3 b) {
+    Vec3 r = { a.x - b.x, a.y - b.y, a.z - b.z };
+    return r;
+}
+
+static inline Vec3 Vec3_Scale(Vec3 v, float s) {
+    Vec3 r = { v.x * s, v.y * s, v.z * s };
+    return r;
+}
+
+static inline Vec3 Vec3_Mul(Vec3 a, Vec3 b) {
+    Vec3 r = { a.x * b.x, a.y * b.y, a.z * b.z };
+    return r;
+}
+
+// a + b * s
+static inline Vec3 Vec3_AddScaled(Vec3 a, Vec3 b, float s) {
+    Vec3 r = { a.x + b.x * s, a.y + b.y * s, a.z + b.z * s };
+    return r;
+}
+
+static inline float Vec3_Dot(Vec3 a, Vec3 b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static inline Vec3 Vec3_Cross(Vec3 a, Vec3 b) {
+    Vec3 r = { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+    return r;
+}
+
+static inline float Vec3_Length(Vec3 v) {
+    return sqrtf(Vec3_Dot(v, v));
+}
+
+// --- Vec4f ---
+
+static inline Vec4f Vec4f_Set(float x, float y, float z, float w) {
+    Vec4f r;
+#ifdef MATH3D_SSE
+    r.v = _mm_set_ps(w, z, y, x);
+#else
+    r.f[0] = x; r.f[1] = y; r.f[2] = z; r.f[3] = w;
+#endif
+    return r;
+}
+
+static inline Vec4f Vec4f_Splat(float s) {
+    return Vec4f_Set(s, s, s, s);
+}
+
+static inline Vec4f Vec4f_FromVec3(Vec3 v, float w) {
+    return Vec4f_Set(v.x, v.y, v.z, w);
+}
+
+static inline Vec3 Vec4f_ToVec3(Vec4f v) {
+    Vec3 r = { v.f[0], v.f[1], v.f[2] };
+    return r;
+}
+
+static inline Vec4f Vec4f_Add(Vec4f a, Vec4f b) {
+#ifdef MATH3D_SSE
+    a.v = _mm_add_ps(a.v, b.v);
+#else
+    for (int i = 0; i < 4; i++) a.f[i] += b.f[i];
+#endif
+    return a;
+}
+
+static inline Vec4f Vec4f_Sub(Vec4f a, Vec4f b) {
+#ifdef MATH3D_SSE
+    a.v = _mm_sub_ps(a.v, b.v);
+#else
+    for (int i = 0; i < 4; i++) a.f[i] -= b.f[i];
+#endif
+    return a;
+}
+
+static inline Vec4f Vec4f_Mul(Vec4f a, Vec4f b) {
+#ifdef MATH3D_SSE
+    a.v = _mm_mul_ps(a.v, b.v);
+#else
+    for (int i = 0; i < 4; i++) a.f[i] *= b.f[i];
+#endif
+    return a;
+}
+
+// a + b * c
+static inline Vec4f Vec4f_MulAdd(Vec4f a, Vec4f b, Vec4f c) {
+#ifdef MATH3D_SSE
+    a.v = _mm_add_ps(a.v, _mm_mul_ps(b.v, c.v));
+#else
+    for (int i = 0; i < 4; i++) a.f[i] += b.f[i] * c.f[i];
+#endif
+    return a;
+}
+
+// --- Quaternions (x, y, z vector part, w scalar part) ---
+
+static inline Quat Quat_Identity(void) {
+    Quat q = { 0.0f, 0.0f, 0.0f, 1.0f };
+    return q;
+}
+
+static inline Quat Quat_Mul(Quat a, Quat b) {
+    Quat r = {
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+    };
+    return r;
+}
+
+static inline Quat Quat_Conjugate(Quat q) {
+    Quat r = { -q.x, -q.y, -q.z, q.w };
+    return r;
+}
+
+static inline Quat Quat_Normalize(Quat q) {
+    float len = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+    float inv = len > 0.0f ? 1.0f / len : 0.0f;
+    Quat r = { q.x * inv, q.y * inv, q.z * inv, q.w * inv };
+    return r;
+}
+
+static inline Quat Quat_FromAxisAngle(Vec3 axis, float angle) {
+    float s = sinf(angle * 0.5f);
+    Quat q = { axis.x * s, axis.y * s, axis.z * s, cosf(angle * 0.5f) };
+    return q;
+}
+
+// Rotation about X, then Y, then Z (the order the renderer used for Euler angles).
+static inline Quat Quat_FromEuler(float x, float y, float z) {
+    float cx = cosf(x * 0.5f), sx = sinf(x * 0.5f);
+    float cy = cosf(y * 0.5f), sy = sinf(y * 0.5f);
+    float cz = cosf(z * 0.5f), sz = sinf(z * 0.5f);
+    Quat q = {
+        sx * cy * cz - cx * sy * sz,
+        cx * sy * cz + sx * cy * sz,
+        cx * cy * sz - sx * sy * cz,
+        cx * cy * cz + sx * sy * sz
+    };
+    return q;
+}
+
+// v' = q v q*, expanded to avoid building a matrix.
+static inline Vec3 Quat_RotateVec3(Quat q, Vec3 v) {
+    Vec3 u = { q.x, q.y, q.z };
+    Vec3 t = Vec3_Scale(Vec3_Cross(u, v), 2.0f);
+    return Vec3_Add(Vec3_AddScaled(v, t, q.w), Vec3_Cross(u, t));
+}
+
+// Advance an orientation by angular velocity w (radians/second) over dt.
+static inline Quat Quat_Integrate(Quat q, Vec3 w, float dt) {
+    Quat spin = { w.x * 0.5f * dt, w.y * 0.5f * dt, w.z * 0.5f * dt, 0.0f };
+    Quat d = Quat_Mul(spin, q);
+    Quat r = { q.x + d.x, q.y + d.y, q.z + d.z, q.w + d.w };
+    return Quat_Normalize(r);
+}
+
+// --- Matrices ---
+
+static inline Mat4 Mat4_Identity(void) {
+    Mat4 m;
+    m.col[0] = Vec4f_Set(1.0f, 0.0f, 0.0f, 0.0f);
+    m.col[1] = Vec4f_Set(0.0f, 1.0f, 0.0f, 0.0f);
+    m.col[2] = Vec4f_Set(0.0f, 0.0f, 1.0f, 0.0f);
+    m.col[3] = Vec4f_Set(0.0f, 0.0f, 0.0f, 1.0f);
+    return m;
+}
+
+// a * b
+static inline Mat4 Mat4_Mul(const Mat4* a, const Mat4* b) {
+    Mat4 r;
+    for (int c = 0; c < 4; c++) {
+        Vec4f acc = Vec4f_Mul(a->col[0], Vec4f_Splat(b->col[c].f[0]));
+        acc = Vec4f_MulAdd(acc, a->col[1], Vec4f_Splat(b->col[c].f[1]));
+        acc = Vec4f_MulAdd(acc, a->col[2], Vec4f_Splat(b->col[c].f[2]));
+        acc = Vec4f_MulAdd(acc, a->col[3], Vec4f_Splat(b->col[c].f[3]));
+        r.col[c] = acc;
+    }
+    return r;
+}
+
+static inline Vec3 Mat4_TransformPoint(const Mat4* m, Vec3 p) {
+    Vec4f r = Vec4f_MulAdd(m->col[3], m->col[0], Vec4f_Splat(p.x));
+    r = Vec4f_MulAdd(r, m->col[1], Vec4f_Splat(p.y));
+    r = Vec4f_MulAdd(r, m->col[2], Vec4f_Splat(p.z));
+    return Vec4f_ToVec3(r);
+}
+
+static inline Mat4 Mat4_FromMat3x4(const Mat3x4* a) {
+    Mat4 m;
+    for (int c = 0; c < 4; c++) {
+        m.col[c] = Vec4f_Set(a->row[0].f[c], a->row[1].f[c], a->row[2].f[c], c == 3 ? 1.0f : 0.0f);
+    }
+    return m;
+}
+
+// Build the affine matrix for translation * rotation * scale.
+Mat3x4 Mat3x4_FromTransform(const Transform* t);
+
+// --- Batched operations ---
+
+// Rotation matrices (zero translation) for n unit quaternions, four at a time.
+void Math3D_QuatToMat3x4Batch(const Quat* q, Mat3x4* out, int n);
+
+// Model matrices for n transforms, four at a time.
+void Math3D_TransformToMat3x4Batch(const Transform* t, Mat3x4* out, int n);
+
+// out[i] = m * in[i]. in and out may alias.
+void Math3D_TransformPoints(const Mat4* m, const Vec3* in, Vec3* out, int n);
+
+#endif // MATH3D_H
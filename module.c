@@ -1,15 +1,23 @@
 #include "module.h"
-#include <stdio.h>
+#include "logger.h"
+#include <assert.h>
 
-Module* moduleRegistry[MAX_MODULES];
-int moduleCount = 0;
+void ModuleRegistry_Init(ModuleRegistry* registry) {
+    registry->count = 0;
+}
 
-void registerModule(Module* mod) {
-    if (moduleCount < MAX_MODULES) {
-        moduleRegistry[moduleCount++] = mod;
-        printf("Module '%s' registered.\n", mod->name);
+void registerModule(ModuleRegistry* registry, const Module* mod, void* context) {
+    assert(registry && "Module registry is NULL.");
+    if (registry->count < MAX_MODULES) {
+        registry->modules[registry->count] = mod;
+        registry->contexts[registry->count] = context;
+        registry->count++;
+        if (mod->init) {
+            mod->init(context);
+        }
+        LOG_INFO("Module '%s' registered.\n", mod->name);
     }
     else {
-        printf("Module registry is full. Cannot register '%s'.\n", mod->name);
+        LOG_ERROR("Module registry is full. Cannot register '%s'.\n", mod->name);
     }
 }
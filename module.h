@@ -1,20 +1,32 @@
 #ifndef MODULE_H
 #define MODULE_H
 
-// A generic Module interface.
+// A generic Module interface. A Module is an immutable description that can be
+// registered with any number of worlds; per-world state is passed as the context.
 typedef struct Module {
     const char* name;
-    void (*init)(void);       // Called once when the module is registered.
-    void (*update)(float dt); // Called each frame (or on a schedule).
+    void (*init)(void* context);              // Called once when the module is registered.
+    void (*update)(void* context, float dt);  // Called each frame (or on a schedule).
+    // Optional amortized work. The scheduler calls it repeatedly while the module's
+    // time budget lasts; return nonzero if work remains so it resumes next frame.
+    int (*step)(void* context);
+    double budgetMs;          // Per-frame time budget (0 uses the scheduler default).
     // Additional functions (e.g., shutdown) can be added here.
 } Module;
 
 #define MAX_MODULES 32
 
-extern Module* moduleRegistry[MAX_MODULES];
-extern int moduleCount;
+// The modules registered with one world.
+typedef struct ModuleRegistry {
+    const Module* modules[MAX_MODULES];
+    void* contexts[MAX_MODULES];
+    int count;
+} ModuleRegistry;
 
-// Function to register a module.
-void registerModule(Module* mod);
+// Initialize an empty registry.
+void ModuleRegistry_Init(ModuleRegistry* registry);
+
+// Function to register a module. context is passed to every callback.
+void registerModule(ModuleRegistry* registry, const Module* mod, void* context);
 
 #endif // MODULE_H
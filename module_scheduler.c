@@ -0,0 +1,110 @@
+#include "module_scheduler.h"
+#include "logger.h"
+#include <SDL3/SDL.h>
+#include <string.h>
+#include <assert.h>
+
+static double ElapsedMs(Uint64 start, Uint64 end) {
+    return (double)(end - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static void DefaultOverrunHandler(const Module* mod, const ModuleStats* stats, double budgetMs, void* userData) {
+    (void)userData;
+    LOG_WARN("Module '%s' overran its budget: %.3f ms (budget %.3f ms, %u overruns)\n",
+        mod->name, stats->lastMs, budgetMs, stats->overruns);
+}
+
+void ModuleScheduler_Init(ModuleScheduler* sched, ModuleRegistry* registry, double frameBudgetMs, double defaultBudgetMs) {
+    memset(sched, 0, sizeof(*sched));
+    sched->registry = registry;
+    sched->frameBudgetMs = frameBudgetMs;
+    sched->defaultBudgetMs = defaultBudgetMs;
+    sched->onOverrun = DefaultOverrunHandler;
+}
+
+void ModuleScheduler_SetOverrunHandler(ModuleScheduler* sched, ModuleOverrunFunc func, void* userData) {
+    sched->onOverrun = func;
+    sched->overrunUserData = userData;
+}
+
+void ModuleScheduler_Tick(ModuleScheduler* sched, float dt) {
+    ModuleRegistry* registry = sched->registry;
+    double spentMs[MAX_MODULES];
+    Uint64 frameStart = SDL_GetPerformanceCounter();
+
+    // Per-frame updates always run, in registration order.
+    for (int i = 0; i < registry->count; i++) {
+        const Module* mod = registry->modules[i];
+        spentMs[i] = 0.0;
+        if (mod->update) {
+            Uint64 start = SDL_GetPerformanceCounter();
+            mod->update(registry->contexts[i], dt);
+            spentMs[i] = ElapsedMs(start, SDL_GetPerformanceCounter());
+        }
+    }
+
+    // Amortized work gets whatever is left of the frame budget, starting where the
+    // last frame stopped so a module cut short one frame goes first the next.
+    int count = registry->count;
+    int start = (count > 0) ? sched->nextStart % count : 0;
+    int frameExhausted = 0;
+    for (int k = 0; k < count; k++) {
+        int i = (start + k) % count;
+        const Module* mod = registry->modules[i];
+        ModuleStats* stats = &sched->stats[i];
+        if (!mod->step) {
+            continue;
+        }
+        if (frameExhausted) {
+            if (stats->pending) {
+                stats->deferred++;
+            }
+            continue;
+        }
+
+        double budgetMs = (mod->budgetMs > 0.0) ? mod->budgetMs : sched->defaultBudgetMs;
+        Uint64 stepStart = SDL_GetPerformanceCounter();
+        int more = 1;
+        while (more) {
+            more = mod->step(registry->contexts[i]);
+            Uint64 now = SDL_GetPerformanceCounter();
+            if (spentMs[i] + ElapsedMs(stepStart, now) >= budgetMs) {
+                break;
+            }
+            if (ElapsedMs(frameStart, now) >= sched->frameBudgetMs) {
+                frameExhausted = 1;
+                sched->nextStart = i + 1;
+                break;
+            }
+        }
+        spentMs[i] += ElapsedMs(stepStart, SDL_GetPerformanceCounter());
+        stats->pending = more;
+        if (frameExhausted && more) {
+            // Resume with this module next frame since it still has work.
+            sched->nextStart = i;
+            stats->deferred++;
+        }
+    }
+    if (!frameExhausted) {
+        sched->nextStart = start + 1;
+    }
+
+    // Record timings and report modules that overran their budget.
+    for (int i = 0; i < count; i++) {
+        const Module* mod = registry->modules[i];
+        ModuleStats* stats = &sched->stats[i];
+        double budgetMs = (mod->budgetMs > 0.0) ? mod->budgetMs : sched->defaultBudgetMs;
+        stats->lastMs = spentMs[i];
+        stats->totalMs += spentMs[i];
+        if (spentMs[i] > stats->worstMs) {
+            stats->worstMs = spentMs[i];
+        }
+        if (spentMs[i] > budgetMs) {
+            stats->overruns++;
+            if (sched->onOverrun) {
+                sched->onOverrun(mod, stats, budgetMs, sched->overrunUserData);
+            }
+        }
+    }
+    sched->frame++;
+}
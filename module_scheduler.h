@@ -0,0 +1,41 @@
+#ifndef MODULE_SCHEDULER_H
+#define MODULE_SCHEDULER_H
+
+#include <stdint.h>
+#include "module.h"
+
+// Per-module timing collected by the scheduler.
+typedef struct {
+    double lastMs;       // Time spent in the module last frame (update + steps).
+    double worstMs;      // Worst frame time observed.
+    double totalMs;      // Accumulated time since the scheduler was initialized.
+    uint32_t overruns;   // Frames where the module exceeded its budget.
+    uint32_t deferred;   // Frames where amortized work was cut short by the frame budget.
+    int pending;         // Amortized work remains from a previous frame.
+} ModuleStats;
+
+// Called when a module runs over its budget.
+typedef void (*ModuleOverrunFunc)(const Module* mod, const ModuleStats* stats, double budgetMs, void* userData);
+
+// Ticks every module of a registry, bounding the time spent on amortized work.
+typedef struct {
+    ModuleRegistry* registry;
+    double frameBudgetMs;     // Total time all modules may use per frame.
+    double defaultBudgetMs;   // Budget for modules that don't set their own.
+    int nextStart;            // Round-robin start for amortized work so nobody starves.
+    uint64_t frame;
+    ModuleStats stats[MAX_MODULES];
+    ModuleOverrunFunc onOverrun;
+    void* overrunUserData;
+} ModuleScheduler;
+
+// Initialize the scheduler. Overruns are logged as warnings until a handler is set.
+void ModuleScheduler_Init(ModuleScheduler* sched, ModuleRegistry* registry, double frameBudgetMs, double defaultBudgetMs);
+
+// Replace the overrun handler (NULL disables reporting).
+void ModuleScheduler_SetOverrunHandler(ModuleScheduler* sched, ModuleOverrunFunc func, void* userData);
+
+// Run one frame: every module's update, then amortized steps while budget remains.
+void ModuleScheduler_Tick(ModuleScheduler* sched, float dt);
+
+#endif // MODULE_SCHEDULER_H
@@ -0,0 +1,25 @@
+#ifndef PARENT_COMPONENT_H
+#define PARENT_COMPONENT_H
+
+#include "components.h"
+#include "ComponentArray.h"
+
+// Attaches an entity to another one. The child's Transform is derived each frame
+// by the HierarchySystem from its parent's world transform and `local`.
+typedef struct {
+    Entity parent;
+    Transform local;  // Position, rotation and scale relative to the parent.
+} Parent;
+
+DEFINE_COMPONENT_ARRAY(Parent);
+
+// Each entity's children as a doubly linked list, so a parent's children are found
+// without scanning the Parent components. Maintained by the Coordinator's Parent
+// functions (see Coordinator_EnableParentLinks).
+typedef struct {
+    int firstChild[MAX_ENTITIES];     // -1 if the entity has no children.
+    int nextSibling[MAX_ENTITIES];
+    int prevSibling[MAX_ENTITIES];
+} ParentLinks;
+
+#endif // PARENT_COMPONENT_H
@@ -0,0 +1,395 @@
+#include "perf_suite.h"
+#include "world.h"
+#include "soft_raster.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Timings this small are mostly noise; allow this much on top of the tolerance.
+#define PERF_ABSOLUTE_SLACK_MS 0.02
+#define PERF_MAX_SCENARIOS 32
+#define PERF_MAX_REPEATS 64
+// Calibration timings that move by more than this (before and after a scenario, or
+// against the baseline's) mean the machine is not steady enough to compare against.
+#define PERF_CALIBRATION_LIMIT 0.10
+
+typedef struct PerfScenario PerfScenario;
+struct PerfScenario {
+    const char* name;
+    int blocks;               // Falling blocks the scenario spawns.
+    int repeats;
+    // Time one repetition into samples[i] for every i < repeats. Returns 0 on success.
+    int (*run)(const PerfScenario* scenario, JobSystem* jobs, double* samples);
+    const char* description;
+};
+
+typedef struct {
+    char name[64];
+    double ms;
+    int maxEntities;          // MAX_ENTITIES of the build that recorded it (0: unknown).
+    double calibration;       // Calibration timed around it (0: unknown).
+} PerfBaseline;
+
+static double ElapsedMs(Uint64 start) {
+    return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+// World_SpawnFallingBlocks gives every tenth block a satellite.
+static int EntitiesFor(int blocks) {
+    return blocks + (blocks + 9) / 10;
+}
+
+static World* CreateWorld(JobSystem* jobs, int blocks) {
+    WorldConfig config;
+    WorldConfig_Default(&config);
+    config.jobs = jobs;
+    config.seed = 1234;
+    config.loadModules = 0;
+    World* world = malloc(sizeof(World));
+    if (!world || World_Init(world, &config) != 0) {
+        free(world);
+        return NULL;
+    }
+    World_SpawnFallingBlocks(world, blocks);
+    return world;
+}
+
+static void FreeWorld(World* world) {
+    World_Destroy(world);
+    free(world);
+}
+
+static int CompareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double Median(double* samples, int count) {
+    qsort(samples, (size_t)count, sizeof(double), CompareDoubles);
+    return count % 2 ? samples[count / 2] : 0.5 * (samples[count / 2 - 1] + samples[count / 2]);
+}
+
+// Fixed CPU and memory work, timed around every scenario. Scenario times are
+// compared relative to it, so a machine that is uniformly slower today (clock,
+// neighbours) does not read as a regression.
+static double Calibrate(void) {
+    const size_t bytes = 4u << 20;
+    float* buffer = malloc(bytes);
+    if (!buffer) {
+        return 0.0;
+    }
+    const int count = (int)(bytes / sizeof(float));
+    double samples[9];
+    volatile float sink = 0.0f;
+    for (int r = 0; r < 9; r++) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        uint32_t rng = 12345;
+        for (int i = 0; i < count; i++) {
+            rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+            buffer[i] = (float)(rng & 0xFFFF) * 0.001f;
+        }
+        float sum = 0.0f;
+        for (int pass = 0; pass < 4; pass++) {
+            for (int i = 0; i < count; i++) {
+                sum += buffer[i] * buffer[(i * 7) & (count - 1)];
+            }
+        }
+        sink = sum;
+        samples[r] = ElapsedMs(start);
+    }
+    (void)sink;
+    free(buffer);
+    return Median(samples, 9);
+}
+
+// --- Scenarios ---
+
+// Spawn every block into an empty world.
+static int RunSpawnStorm(const PerfScenario* scenario, JobSystem* jobs, double* samples) {
+    for (int r = 0; r < scenario->repeats; r++) {
+        World* world = CreateWorld(jobs, 0);
+        if (!world) {
+            return -1;
+        }
+        Uint64 start = SDL_GetPerformanceCounter();
+        World_SpawnFallingBlocks(world, scenario->blocks);
+        samples[r] = ElapsedMs(start);
+        FreeWorld(world);
+    }
+    return 0;
+}
+
+// Destroy every entity of a populated world.
+static int RunMassDestroy(const PerfScenario* scenario, JobSystem* jobs, double* samples) {
+    Entity* entities = malloc(sizeof(Entity) * (size_t)EntitiesFor(scenario->blocks));
+    if (!entities) {
+        return -1;
+    }
+    for (int r = 0; r < scenario->repeats; r++) {
+        World* world = CreateWorld(jobs, scenario->blocks);
+        if (!world) {
+            free(entities);
+            return -1;
+        }
+        // Every spawned entity has a Transform.
+        int count = (int)world->transformArray->size;
+        memcpy(entities, world->transformArray->indexToEntityMap, sizeof(Entity) * (size_t)count);
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int i = 0; i < count; i++) {
+            Coordinator_DestroyEntity(&world->coordinator, entities[i]);
+        }
+        samples[r] = ElapsedMs(start);
+        FreeWorld(world);
+    }
+    free(entities);
+    return 0;
+}
+
+// Consecutive physics steps of a falling scene, after a few to settle the caches.
+static int RunPhysicsStep(const PerfScenario* scenario, JobSystem* jobs, double* samples) {
+    World* world = CreateWorld(jobs, scenario->blocks);
+    if (!world) {
+        return -1;
+    }
+    for (int i = 0; i < 5; i++) {
+        PhysicsSystem_Update(world->physicsSystem, 0.016f);
+    }
+    for (int r = 0; r < scenario->repeats; r++) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        PhysicsSystem_Update(world->physicsSystem, 0.016f);
+        samples[r] = ElapsedMs(start);
+    }
+    FreeWorld(world);
+    return 0;
+}
+
+// Gather, project, cull and sort the cubes and queue their triangles; the
+// rasterization itself is left out.
+static int RunRenderPrep(const PerfScenario* scenario, JobSystem* jobs, double* samples) {
+    World* world = CreateWorld(jobs, scenario->blocks);
+    SoftRaster* raster = malloc(sizeof(SoftRaster));
+    if (!world || !raster || SoftRaster_Init(raster, 1280, 720, jobs) != 0) {
+        if (world) FreeWorld(world);
+        free(raster);
+        return -1;
+    }
+    Render3DTarget target = { NULL, raster, 1280, 720 };
+    SDL_Color clear = { 0, 0, 0, 255 };
+    for (int r = 0; r < scenario->repeats; r++) {
+        SoftRaster_BeginFrame(raster, clear);
+        Uint64 start = SDL_GetPerformanceCounter();
+        World_Render(world, &target);
+        samples[r] = ElapsedMs(start);
+    }
+    SoftRaster_Shutdown(raster);
+    free(raster);
+    FreeWorld(world);
+    return 0;
+}
+
+// Tag every physics body static and back: signature updates, each matched against
+// every system.
+static int RunSignatureChurn(const PerfScenario* scenario, JobSystem* jobs, double* samples) {
+    World* world = CreateWorld(jobs, scenario->blocks);
+    if (!world) {
+        return -1;
+    }
+    int count = world->physicsSystem->base.count;
+    Entity* bodies = malloc(sizeof(Entity) * (size_t)(count > 0 ? count : 1));
+    if (!bodies) {
+        FreeWorld(world);
+        return -1;
+    }
+    memcpy(bodies, world->physicsSystem->base.entities, sizeof(Entity) * (size_t)count);
+    for (int r = 0; r < scenario->repeats; r++) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int i = 0; i < count; i++) {
+            Coordinator_AddTag(&world->coordinator, bodies[i], TAG_STATIC);
+        }
+        for (int i = 0; i < count; i++) {
+            Coordinator_RemoveTag(&world->coordinator, bodies[i], TAG_STATIC);
+        }
+        samples[r] = ElapsedMs(start);
+    }
+    free(bodies);
+    FreeWorld(world);
+    return 0;
+}
+
+static const PerfScenario scenarios[] = {
+    { "spawn_storm", 5000, 7, RunSpawnStorm, "Spawn 5000 blocks (5500 entities) into an empty world" },
+    { "mass_destroy", 5000, 7, RunMassDestroy, "Destroy all 5500 entities of a world" },
+    { "physics_step_1k", 1000, 31, RunPhysicsStep, "One physics step of 1000 falling bodies" },
+    { "physics_step_100k", 100000, 11, RunPhysicsStep, "One physics step of 100000 falling bodies" },
+    { "render_prep", 5000, 21, RunRenderPrep, "Project, cull and sort 5500 cubes into the software rasterizer" },
+    { "signature_churn", 5000, 11, RunSignatureChurn, "Tag and untag 5000 physics bodies (signature churn)" },
+};
+#define SCENARIO_COUNT ((int)(sizeof(scenarios) / sizeof(scenarios[0])))
+
+// --- Baseline file ---
+
+static int LoadBaseline(const char* path, PerfBaseline* entries, int capacity) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return 0;
+    }
+    int count = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), file) && count < capacity) {
+        if (line[0] == '#') {
+            continue;
+        }
+        PerfBaseline* entry = &entries[count];
+        entry->maxEntities = 0;
+        entry->calibration = 0.0;
+        if (sscanf(line, "%63s %lf %d %lf", entry->name, &entry->ms, &entry->maxEntities, &entry->calibration) >= 2) {
+            count++;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+static PerfBaseline* FindBaseline(PerfBaseline* entries, int count, const char* name) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(entries[i].name, name) == 0) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+static int SaveBaseline(const char* path, const PerfBaseline* entries, int count) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return -1;
+    }
+    fprintf(file, "# Performance baseline: scenario, median milliseconds, MAX_ENTITIES of the\n");
+    fprintf(file, "# build that recorded it, and calibration milliseconds timed around it.\n");
+    fprintf(file, "# Regenerate with --perf-update on the reference machine; entries for scenarios\n");
+    fprintf(file, "# a build skips are kept as they are.\n");
+    for (int i = 0; i < count; i++) {
+        fprintf(file, "%s %.4f %d %.4f\n", entries[i].name, entries[i].ms, entries[i].maxEntities,
+            entries[i].calibration);
+    }
+    return fclose(file) == 0 ? 0 : -1;
+}
+
+// --- Suite ---
+
+void PerfSuiteConfig_Default(PerfSuiteConfig* config, JobSystem* jobs) {
+    config->baselinePath = PERF_DEFAULT_BASELINE;
+    config->tolerance = PERF_DEFAULT_TOLERANCE;
+    config->updateBaseline = 0;
+    config->only = NULL;
+    config->jobs = jobs;
+}
+
+int PerfSuite_Run(const PerfSuiteConfig* config) {
+    PerfBaseline baseline[PERF_MAX_SCENARIOS];
+    int baselineCount = LoadBaseline(config->baselinePath, baseline, PERF_MAX_SCENARIOS);
+    if (baselineCount == 0 && !config->updateBaseline) {
+        printf("perf: no baseline in %s; results are not compared\n", config->baselinePath);
+    }
+
+    printf("perf: MAX_ENTITIES %d, tolerance %.0f%%, baseline %s\n",
+        MAX_ENTITIES, config->tolerance * 100.0, config->baselinePath);
+
+    printf(" %-20s %11s %11s %6s %9s  %s\n", "scenario", "median ms", "expected", "scale", "change", "result");
+
+    int regressions = 0, failures = 0, ran = 0, unstable = 0, uncompared = 0;
+    double samples[PERF_MAX_REPEATS];
+    for (int s = 0; s < SCENARIO_COUNT; s++) {
+        const PerfScenario* scenario = &scenarios[s];
+        if (config->only && strcmp(config->only, scenario->name) != 0) {
+            continue;
+        }
+        int needed = EntitiesFor(scenario->blocks);
+        if (needed > MAX_ENTITIES) {
+            printf(" %-20s %11s %11s %6s %9s  skipped (needs MAX_ENTITIES >= %d)\n", scenario->name, "-", "-", "-", "-",
+                needed);
+            continue;
+        }
+        // Calibrate right before and after the scenario, so the scale reflects the
+        // machine while it ran rather than at the start of the suite.
+        double before = Calibrate();
+        int result = scenario->run(scenario, config->jobs, samples);
+        double after = Calibrate();
+        if (result != 0) {
+            printf(" %-20s %11s %11s %6s %9s  FAILED to run\n", scenario->name, "-", "-", "-", "-");
+            failures++;
+            continue;
+        }
+        double ms = Median(samples, scenario->repeats);
+        double calibration = 0.5 * (before + after);
+        int steady = before > 0.0 && after > 0.0 && fabs(after / before - 1.0) <= PERF_CALIBRATION_LIMIT;
+        ran++;
+
+        PerfBaseline* base = FindBaseline(baseline, baselineCount, scenario->name);
+        if (config->updateBaseline) {
+            if (!steady) {
+                printf(" %-20s %11.4f %11s %6s %9s  unstable calibration (%.3f then %.3f ms), not recorded\n",
+                    scenario->name, ms, "-", "-", "-", before, after);
+                unstable++;
+                continue;
+            }
+            if (!base && baselineCount < PERF_MAX_SCENARIOS) {
+                base = &baseline[baselineCount++];
+                snprintf(base->name, sizeof(base->name), "%s", scenario->name);
+            }
+            if (base) {
+                base->ms = ms;
+                base->maxEntities = MAX_ENTITIES;
+                base->calibration = calibration;
+            }
+            printf(" %-20s %11.4f %11s %6s %9s  recorded\n", scenario->name, ms, "-", "-", "-");
+            continue;
+        }
+        if (!base) {
+            printf(" %-20s %11.4f %11s %6s %9s  no baseline\n", scenario->name, ms, "-", "-", "-");
+            continue;
+        }
+        // MAX_ENTITIES sizes every per-entity array, so a baseline from another build
+        // says little about this one.
+        if (base->maxEntities > 0 && base->maxEntities != MAX_ENTITIES) {
+            printf(" %-20s %11.4f %11s %6s %9s  not compared (recorded with MAX_ENTITIES %d)\n",
+                scenario->name, ms, "-", "-", "-", base->maxEntities);
+            uncompared++;
+            continue;
+        }
+        double scale = base->calibration > 0.0 && steady ? calibration / base->calibration : 1.0;
+        if (!steady || fabs(scale - 1.0) > PERF_CALIBRATION_LIMIT) {
+            printf(" %-20s %11.4f %11s %6.2f %9s  unstable calibration (%.3f then %.3f ms, %.3f at baseline)\n",
+                scenario->name, ms, "-", scale, "-", before, after, base->calibration);
+            unstable++;
+            continue;
+        }
+        double expected = base->ms * scale;
+        double change = expected > 0.0 ? (ms - expected) / expected * 100.0 : 0.0;
+        int regressed = ms > expected * (1.0 + config->tolerance) + PERF_ABSOLUTE_SLACK_MS;
+        regressions += regressed;
+        printf(" %-20s %11.4f %11.4f %6.2f %+8.1f%%  %s\n", scenario->name, ms, expected, scale, change,
+            regressed ? "REGRESSION" : "ok");
+    }
+
+    if (config->updateBaseline) {
+        if (SaveBaseline(config->baselinePath, baseline, baselineCount) != 0) {
+            fprintf(stderr, "perf: failed to write %s\n", config->baselinePath);
+            return 1;
+        }
+        printf("perf: wrote %d entries to %s, %d unstable not recorded\n", baselineCount, config->baselinePath,
+            unstable);
+        return (failures || unstable) ? 1 : 0;
+    }
+    printf("perf: %d scenarios run, %d regressions, %d failures, %d unstable calibration, %d from another build\n",
+        ran, regressions, failures, unstable, uncompared);
+    return (regressions || failures) ? 1 : 0;
+}
+
+void PerfSuite_List(void) {
+    printf("Perf scenarios:\n");
+    for (int s = 0; s < SCENARIO_COUNT; s++) {
+        printf("  %-20s %s\n", scenarios[s].name, scenarios[s].description);
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef PERF_SUITE_H
+#define PERF_SUITE_H
+
+#include "job_system.h"
+
+// Performance regression suite: fixed, seeded scenarios run headless, each timed as
+// the median of several repetitions and compared with a baseline file.
+//
+// The baseline is plain text, one "name milliseconds max_entities calibration" line
+// per scenario ('#' starts a comment): the MAX_ENTITIES of the build that recorded
+// it and a fixed calibration workload timed around it. Calibration is re-timed
+// around every scenario and the baseline scaled by how much faster or slower it runs
+// now. A scenario regresses when it is slower than its scaled baseline by more than
+// the tolerance (plus a small absolute slack for sub-millisecond timings).
+//
+// Scenarios are reported but not compared when they have no baseline, when it came
+// from a build with another MAX_ENTITIES, or when the calibration is unstable: it
+// moved by more than 10% across the scenario or against the baseline's. Scenarios
+// that need more entities than MAX_ENTITIES are skipped. Baselines are only
+// meaningful on the machine they were recorded on.
+
+#define PERF_DEFAULT_BASELINE "perf_baseline.txt"
+#define PERF_DEFAULT_TOLERANCE 0.25   // 25% slower than the baseline fails.
+
+typedef struct {
+    const char* baselinePath;
+    double tolerance;         // Allowed slowdown as a fraction of the baseline.
+    int updateBaseline;       // Write the results to baselinePath instead of comparing.
+    const char* only;         // Run just this scenario (NULL: all).
+    JobSystem* jobs;
+} PerfSuiteConfig;
+
+void PerfSuiteConfig_Default(PerfSuiteConfig* config, JobSystem* jobs);
+
+// Run the suite. Returns 0 if nothing regressed (or the baseline was written), 1 on
+// a regression or failure.
+int PerfSuite_Run(const PerfSuiteConfig* config);
+
+// Print the scenario names.
+void PerfSuite_List(void);
+
+#endif // PERF_SUITE_H
@@ -1,35 +1,644 @@
 #include "physics_system.h"
+#include "math3d.h"
+#include "logger.h"
 #include <assert.h>
+#include <math.h>
+#include <stdlib.h>
 
-void PhysicsSystem_Init(PhysicsSystem* psys, ComponentManager* cm) {
-    psys->base.count = 0;
+static void OnBodyRemoved(ECS_System* sys, Entity entity);
+
+void PhysicsSystem_Init(PhysicsSystem* psys, ComponentManager* cm, Arena* scratch) {
+    ECS_System_Init(&psys->base, "Physics");
+    psys->base.onRemove = OnBodyRemoved;
     psys->base.requiredSignature = (1 << COMPONENT_TRANSFORM) |
         (1 << COMPONENT_RIGID_BODY) |
         (1 << COMPONENT_GRAVITY);
     psys->componentManager = cm;
+    psys->scratch = scratch;
+
+    psys->hasGround = 0;
+    psys->groundHeight = 0.0f;
+    psys->restitution = 0.2f;
+    psys->friction = 2.0f;
+
+    psys->activeCount = 0;
+    psys->activeVersion = 0;
+    psys->epoch = 1;
+    psys->syncedVersion = 0;
+    psys->contactSolver = NULL;
+    psys->lod = NULL;
+    psys->staticTags = NULL;
+    psys->solverBodies = NULL;
+    psys->solverCount = 0;
+    psys->fallingAsleep = NULL;
+    psys->fallingAsleepCount = 0;
+    for (int i = 0; i < MAX_ENTITIES; i++) {
+        psys->activeIndex[i] = -1;
+        psys->sleepTimer[i] = 0.0f;
+        psys->memberEpoch[i] = 0;
+        psys->supported[i] = 0;
+        psys->solverSlot[i] = -1;
+        psys->sleepGrid.bucket[i] = -1;
+        psys->sleepGrid.index[i] = -1;
+    }
+    for (int i = 0; i < PHYSICS_GRID_BUCKETS; i++) {
+        psys->sleepGrid.head[i] = -1;
+    }
+    psys->sleepGrid.count = 0;
+    psys->sleepGrid.cellSize = 0.0f;
+    psys->sleepGrid.maxRadius = 0.0f;
 }
 
-void PhysicsSystem_Update(PhysicsSystem* psys, float dt) {
-    // Retrieve the component arrays from the ComponentManager.
-    TransformComponentArray* transformArray = (TransformComponentArray*)psys->componentManager->componentArrays[COMPONENT_TRANSFORM];
-    RigidBodyComponentArray* rigidBodyArray = (RigidBodyComponentArray*)psys->componentManager->componentArrays[COMPONENT_RIGID_BODY];
-    GravityComponentArray* gravityArray = (GravityComponentArray*)psys->componentManager->componentArrays[COMPONENT_GRAVITY];
+void PhysicsSystem_SetGround(PhysicsSystem* psys, float height) {
+    psys->hasGround = 1;
+    psys->groundHeight = height;
+}
+
+void PhysicsSystem_SetContactSolver(PhysicsSystem* psys, ContactSolver* solver) {
+    psys->contactSolver = solver;
+}
+
+void PhysicsSystem_SetUpdateLod(PhysicsSystem* psys, UpdateLod* lod) {
+    psys->lod = lod;
+}
+
+void PhysicsSystem_SetStaticTags(PhysicsSystem* psys, const TagBitset* staticTags) {
+    psys->staticTags = staticTags;
+}
+
+static inline int IsStatic(const PhysicsSystem* psys, Entity entity) {
+    return psys->staticTags && TagBitset_Test(psys->staticTags, entity);
+}
+
+// --- Sleeping-body grid ---
+
+static inline int GridCoord(float v, float cellSize) {
+    return (int)floorf(v / cellSize);
+}
+
+static inline int GridBucket(int x, int y, int z) {
+    uint32_t h = (uint32_t)x * 73856093u ^ (uint32_t)y * 19349663u ^ (uint32_t)z * 83492791u;
+    return (int)(h % (uint32_t)PHYSICS_GRID_BUCKETS);
+}
+
+static void GridLink(SleepGrid* grid, Entity entity) {
+    Vec3 p = grid->position[entity];
+    int bucket = GridBucket(GridCoord(p.x, grid->cellSize), GridCoord(p.y, grid->cellSize),
+        GridCoord(p.z, grid->cellSize));
+    int first = grid->head[bucket];
+    grid->bucket[entity] = bucket;
+    grid->prev[entity] = -1;
+    grid->next[entity] = first;
+    if (first != -1) {
+        grid->prev[first] = (int)entity;
+    }
+    grid->head[bucket] = (int)entity;
+}
+
+static void GridUnlink(SleepGrid* grid, Entity entity) {
+    int prev = grid->prev[entity];
+    int next = grid->next[entity];
+    if (prev != -1) {
+        grid->next[prev] = next;
+    }
+    else {
+        grid->head[grid->bucket[entity]] = next;
+    }
+    if (next != -1) {
+        grid->prev[next] = prev;
+    }
+    grid->bucket[entity] = -1;
+}
+
+static void SleepGrid_Insert(SleepGrid* grid, Entity entity, Vec3 position, float radius) {
+    if (grid->index[entity] != -1) {
+        return;
+    }
+    grid->position[entity] = position;
+    grid->radius[entity] = radius;
+    grid->index[entity] = grid->count;
+    grid->entities[grid->count++] = entity;
+    if (radius > grid->maxRadius) {
+        grid->maxRadius = radius;
+    }
+    if (grid->cellSize > 0.0f && 2.0f * radius <= grid->cellSize) {
+        GridLink(grid, entity);
+        return;
+    }
+    // Too big for the cells: widen them and rehash everything (rare).
+    grid->cellSize = radius > 0.0f ? 2.0f * radius : 1.0f;
+    for (int i = 0; i < grid->count - 1; i++) {
+        GridUnlink(grid, grid->entities[i]);
+    }
+    for (int i = 0; i < grid->count; i++) {
+        GridLink(grid, grid->entities[i]);
+    }
+}
+
+static void SleepGrid_Remove(SleepGrid* grid, Entity entity) {
+    int index = grid->index[entity];
+    if (index == -1) {
+        return;
+    }
+    GridUnlink(grid, entity);
+    Entity last = grid->entities[--grid->count];
+    grid->entities[index] = last;
+    grid->index[last] = index;
+    grid->index[entity] = -1;
+    if (grid->count == 0) {
+        grid->maxRadius = 0.0f;
+    }
+}
+
+// Call visit for every body in the grid that overlaps the sphere (p, r).
+static void SleepGrid_Query(PhysicsSystem* psys, Vec3 p, float r, void (*visit)(PhysicsSystem*, Entity)) {
+    const SleepGrid* grid = &psys->sleepGrid;
+    if (grid->count == 0) {
+        return;
+    }
+    float reach = r + grid->maxRadius;
+    int x0 = GridCoord(p.x - reach, grid->cellSize), x1 = GridCoord(p.x + reach, grid->cellSize);
+    int y0 = GridCoord(p.y - reach, grid->cellSize), y1 = GridCoord(p.y + reach, grid->cellSize);
+    int z0 = GridCoord(p.z - reach, grid->cellSize), z1 = GridCoord(p.z + reach, grid->cellSize);
+    int cells = (x1 - x0 + 1) * (y1 - y0 + 1) * (z1 - z0 + 1);
+
+    // A body much larger than the cells is cheaper to test against every sleeper.
+    if (cells > grid->count) {
+        for (int i = 0; i < grid->count; i++) {
+            Entity entity = grid->entities[i];
+            Vec3 d = Vec3_Sub(grid->position[entity], p);
+            float touch = r + grid->radius[entity];
+            if (Vec3_Dot(d, d) < touch * touch) {
+                visit(psys, entity);
+            }
+        }
+        return;
+    }
+    // Cells can share a bucket, so a body may be visited more than once.
+    for (int z = z0; z <= z1; z++) {
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                for (int e = grid->head[GridBucket(x, y, z)]; e != -1; e = grid->next[e]) {
+                    Vec3 d = Vec3_Sub(grid->position[e], p);
+                    float touch = r + grid->radius[e];
+                    if (Vec3_Dot(d, d) < touch * touch) {
+                        visit(psys, (Entity)e);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// --- Active set ---
+
+static void AddActive(PhysicsSystem* psys, Entity entity) {
+    if (psys->activeIndex[entity] != -1) {
+        return;
+    }
+    SleepGrid_Remove(&psys->sleepGrid, entity);
+    psys->activeIndex[entity] = psys->activeCount;
+    psys->active[psys->activeCount++] = entity;
+    psys->activeVersion++;
+}
+
+// Swap-remove from the active list.
+static void RemoveActive(PhysicsSystem* psys, Entity entity) {
+    int index = psys->activeIndex[entity];
+    if (index == -1) {
+        return;
+    }
+    Entity last = psys->active[--psys->activeCount];
+    psys->active[index] = last;
+    psys->activeIndex[last] = index;
+    psys->activeIndex[entity] = -1;
+    psys->activeVersion++;
+}
 
+// Bring the active set in line with the system's membership. Runs only when the
+// membership version changed: new members start awake. Departed ones were already
+// dropped by OnBodyRemoved.
+static void SyncMembership(PhysicsSystem* psys) {
+    uint32_t previous = psys->epoch++;
     for (int i = 0; i < psys->base.count; i++) {
         Entity entity = psys->base.entities[i];
+        if (psys->memberEpoch[entity] != previous) {
+            psys->sleepTimer[entity] = 0.0f;
+            AddActive(psys, entity);
+        }
+        psys->memberEpoch[entity] = psys->epoch;
+    }
+    psys->syncedVersion = psys->base.version;
+}
 
-        Transform* transform = TransformComponentArray_GetData(transformArray, entity);
-        RigidBody* rigidBody = RigidBodyComponentArray_GetData(rigidBodyArray, entity);
-        Gravity* gravity = GravityComponentArray_GetData(gravityArray, entity);
+static void WakeSleeper(PhysicsSystem* psys, Entity entity) {
+    if (IsStatic(psys, entity)) {
+        return;
+    }
+    psys->sleepTimer[entity] = 0.0f;
+    AddActive(psys, entity);
+}
+
+static inline float BodyRadius(const Transform* transform) {
+    float extent = transform->scale.x;
+    if (transform->scale.y > extent) extent = transform->scale.y;
+    if (transform->scale.z > extent) extent = transform->scale.z;
+    return extent * 0.5f;
+}
+
+// Room on the scratch arena for every member as a solver body.
+static int AllocSolverBodies(PhysicsSystem* psys) {
+    psys->solverBodies = ARENA_NEW_ARRAY(psys->scratch, Entity, psys->base.count > 0 ? psys->base.count : 1);
+    psys->solverCount = 0;
+    if (!psys->solverBodies) {
+        LOG_ERROR("PhysicsSystem: scratch arena is full\n");
+        return -1;
+    }
+    return 0;
+}
 
-        // Update the position using the current velocity.
-        transform->position.x += rigidBody->velocity.x * dt;
-        transform->position.y += rigidBody->velocity.y * dt;
-        transform->position.z += rigidBody->velocity.z * dt;
+// Add a sleeping body to this step's solver bodies, once.
+static void GatherSleeper(PhysicsSystem* psys, Entity entity) {
+    if (psys->solverSlot[entity] == -1) {
+        psys->solverSlot[entity] = psys->solverCount;
+        psys->solverBodies[psys->solverCount++] = entity;
+    }
+}
 
-        // Update the velocity based on gravity.
-        rigidBody->velocity.x += gravity->force.x * dt;
-        rigidBody->velocity.y += gravity->force.y * dt;
-        rigidBody->velocity.z += gravity->force.z * dt;
+// Wake the sleeping bodies touching a body (where it fell asleep if it is asleep).
+// Only those: once awake they find out for themselves whether they are still
+// supported. Without contacts sleepers rest on the ground alone, so there is
+// nothing to do.
+static void WakeNeighbours(PhysicsSystem* psys, Entity entity) {
+    const SleepGrid* grid = &psys->sleepGrid;
+    if (!psys->contactSolver || grid->count == 0) {
+        return;
+    }
+    Vec3 position;
+    float radius;
+    if (grid->index[entity] != -1) {
+        position = grid->position[entity];
+        radius = grid->radius[entity];
+    }
+    else {
+        TransformComponentArray* transformArray = (TransformComponentArray*)psys->componentManager->componentArrays[COMPONENT_TRANSFORM];
+        const Transform* transform = TransformComponentArray_GetData(transformArray, entity);
+        position = transform->position;
+        radius = BodyRadius(transform);
+    }
+    size_t mark = Arena_Mark(psys->scratch);
+    if (AllocSolverBodies(psys) != 0) {
+        return;
+    }
+    SleepGrid_Query(psys, position, radius + PHYSICS_CONTACT_SLOP, GatherSleeper);
+    for (int i = 0; i < psys->solverCount; i++) {
+        Entity neighbour = psys->solverBodies[i];
+        psys->solverSlot[neighbour] = -1;
+        if (neighbour != entity) {
+            WakeSleeper(psys, neighbour);
+        }
+    }
+    psys->solverCount = 0;
+    Arena_ResetTo(psys->scratch, mark);
+}
+
+// Removal hook: wake whatever rested on the body and forget its state, so a
+// recycled ID joins as a new body.
+static void OnBodyRemoved(ECS_System* sys, Entity entity) {
+    PhysicsSystem* psys = (PhysicsSystem*)sys;
+    if (psys->memberEpoch[entity] == 0) {
+        return; // Left before it was ever synced.
+    }
+    WakeNeighbours(psys, entity);
+    RemoveActive(psys, entity);
+    SleepGrid_Remove(&psys->sleepGrid, entity);
+    psys->sleepTimer[entity] = 0.0f;
+    psys->memberEpoch[entity] = 0;
+    if (psys->lod) {
+        UpdateLod_Forget(psys->lod, entity);
+    }
+}
+
+void PhysicsSystem_WakeBody(PhysicsSystem* psys, Entity entity) {
+    assert(entity < MAX_ENTITIES && "Entity out of range.");
+    if (psys->syncedVersion != psys->base.version) {
+        SyncMembership(psys);
+    }
+    if (psys->memberEpoch[entity] != psys->epoch) {
+        return; // Not a physics body.
+    }
+    WakeNeighbours(psys, entity);
+    if (IsStatic(psys, entity) && psys->sleepGrid.index[entity] != -1) {
+        TransformComponentArray* transformArray = (TransformComponentArray*)psys->componentManager->componentArrays[COMPONENT_TRANSFORM];
+        const Transform* transform = TransformComponentArray_GetData(transformArray, entity);
+        SleepGrid_Remove(&psys->sleepGrid, entity);
+        SleepGrid_Insert(&psys->sleepGrid, entity, transform->position, BodyRadius(transform));
+        return;
+    }
+    WakeSleeper(psys, entity);
+}
+
+void PhysicsSystem_SetVelocity(PhysicsSystem* psys, Entity entity, Vec3 velocity) {
+    RigidBodyComponentArray* rigidBodyArray = (RigidBodyComponentArray*)psys->componentManager->componentArrays[COMPONENT_RIGID_BODY];
+    RigidBodyComponentArray_GetData(rigidBodyArray, entity)->velocity = velocity;
+    PhysicsSystem_WakeBody(psys, entity);
+}
+
+void PhysicsSystem_ApplyImpulse(PhysicsSystem* psys, Entity entity, Vec3 deltaVelocity) {
+    RigidBodyComponentArray* rigidBodyArray = (RigidBodyComponentArray*)psys->componentManager->componentArrays[COMPONENT_RIGID_BODY];
+    RigidBody* rigidBody = RigidBodyComponentArray_GetData(rigidBodyArray, entity);
+    rigidBody->velocity = Vec3_Add(rigidBody->velocity, deltaVelocity);
+    PhysicsSystem_WakeBody(psys, entity);
+}
+
+void PhysicsSystem_SetPosition(PhysicsSystem* psys, Entity entity, Vec3 position) {
+    TransformComponentArray* transformArray = (TransformComponentArray*)psys->componentManager->componentArrays[COMPONENT_TRANSFORM];
+    // Wake before as well, so what rested on the body at its old position wakes too.
+    PhysicsSystem_WakeBody(psys, entity);
+    TransformComponentArray_GetData(transformArray, entity)->position = position;
+    PhysicsSystem_WakeBody(psys, entity);
+}
+
+int PhysicsSystem_IsSleeping(const PhysicsSystem* psys, Entity entity) {
+    assert(entity < MAX_ENTITIES && "Entity out of range.");
+    return psys->memberEpoch[entity] == psys->epoch && psys->activeIndex[entity] == -1;
+}
+
+// Run the contact solver over the awake bodies and the sleeping ones they overlap.
+// Sleeping and static bodies, and with LOD bodies not due this frame, take part as
+// immovable obstacles; a sleeping one hit by a body faster than the sleep velocity is woken
+// and moves from the next step. Slower bodies just rest on it, so touching bodies in
+// a pile don't keep waking each other. Bodies that are all asleep cost nothing.
+static void ResolveContacts(PhysicsSystem* psys, float dt, TransformComponentArray* transformArray,
+    RigidBodyComponentArray* rigidBodyArray, GravityComponentArray* gravityArray)
+{
+    ContactSolver* solver = psys->contactSolver;
+    int awakeCount = psys->activeCount;
+    if (AllocSolverBodies(psys) != 0 || ContactSolver_SetBodyCount(solver, awakeCount) != 0) {
+        return;
+    }
+    for (int i = 0; i < awakeCount; i++) {
+        Entity entity = psys->active[i];
+        const Transform* transform = TransformComponentArray_GetData(transformArray, entity);
+        const RigidBody* rigidBody = RigidBodyComponentArray_GetData(rigidBodyArray, entity);
+        int asleep = IsStatic(psys, entity) || (psys->lod && !UpdateLod_IsDue(psys->lod, entity));
+        psys->solverBodies[psys->solverCount++] = entity;
+        solver->px[i] = transform->position.x;
+        solver->py[i] = transform->position.y;
+        solver->pz[i] = transform->position.z;
+        solver->vx[i] = asleep ? 0.0f : rigidBody->velocity.x;
+        solver->vy[i] = asleep ? 0.0f : rigidBody->velocity.y;
+        solver->vz[i] = asleep ? 0.0f : rigidBody->velocity.z;
+        solver->invMass[i] = asleep ? 0.0f : rigidBody->inverseMass;
+        solver->radius[i] = BodyRadius(transform);
+        // A due body moves for its accumulated dt, not just this frame's.
+        solver->dt[i] = psys->lod && !asleep ? psys->lod->dt[entity] : 0.0f;
+        solver->asleep[i] = (uint8_t)asleep;
+        psys->supported[entity] = 0;
+    }
+
+    // Only bodies that move this step can run into a sleeping one.
+    for (int i = 0; i < awakeCount; i++) {
+        if (!solver->asleep[i]) {
+            Vec3 position = Vec3_Make(solver->px[i], solver->py[i], solver->pz[i]);
+            SleepGrid_Query(psys, position, solver->radius[i], GatherSleeper);
+        }
+    }
+    int n = psys->solverCount;
+    if (ContactSolver_SetBodyCount(solver, n) != 0) {
+        for (int i = awakeCount; i < n; i++) {
+            psys->solverSlot[psys->solverBodies[i]] = -1;
+        }
+        return;
+    }
+    const SleepGrid* grid = &psys->sleepGrid;
+    for (int i = awakeCount; i < n; i++) {
+        Entity entity = psys->solverBodies[i];
+        psys->solverSlot[entity] = -1;
+        solver->px[i] = grid->position[entity].x;
+        solver->py[i] = grid->position[entity].y;
+        solver->pz[i] = grid->position[entity].z;
+        solver->vx[i] = solver->vy[i] = solver->vz[i] = 0.0f;
+        solver->invMass[i] = 0.0f;
+        solver->radius[i] = grid->radius[entity];
+        solver->dt[i] = 0.0f;
+        solver->asleep[i] = 1;
+    }
+
+    if (ContactSolver_Step(solver, psys->hasGround, psys->groundHeight, dt) != 0) {
+        return;
+    }
+
+    // Velocities are written back below, so the components still hold the speed each
+    // body came in with, plus this step's gravity. That is taken out again: a resting
+    // body gains it every step and loses it in the solve, and with LOD it is several
+    // frames' worth. Bodies LOD skips this frame are awake and are left alone.
+    const float wakeSpeedSq = PHYSICS_SLEEP_VELOCITY * PHYSICS_SLEEP_VELOCITY;
+    for (int c = 0; c < solver->contactCount; c++) {
+        const SolverContact* contact = &solver->contacts[c];
+        if (contact->bodyB < 0 || solver->asleep[contact->bodyA] == solver->asleep[contact->bodyB]) {
+            continue;
+        }
+        int sleeper = solver->asleep[contact->bodyA] ? contact->bodyA : contact->bodyB;
+        int mover = sleeper == contact->bodyA ? contact->bodyB : contact->bodyA;
+        if (psys->activeIndex[psys->solverBodies[sleeper]] != -1) {
+            continue;
+        }
+        Entity moverEntity = psys->solverBodies[mover];
+        Vec3 velocity = RigidBodyComponentArray_GetData(rigidBodyArray, moverEntity)->velocity;
+        float moverDt = solver->dt[mover] > 0.0f ? solver->dt[mover] : dt;
+        velocity = Vec3_AddScaled(velocity, GravityComponentArray_GetData(gravityArray, moverEntity)->force, -moverDt);
+        if (Vec3_Dot(velocity, velocity) > wakeSpeedSq) {
+            WakeSleeper(psys, psys->solverBodies[sleeper]);
+        }
+    }
+    for (int c = 0; c < solver->contactCount; c++) {
+        if (solver->impulse[c] > 0.0f) {
+            psys->supported[psys->solverBodies[solver->bodyA[c]]] = 1;
+            if (solver->bodyB[c] >= 0) {
+                psys->supported[psys->solverBodies[solver->bodyB[c]]] = 1;
+            }
+        }
+    }
+    for (int i = 0; i < awakeCount; i++) {
+        if (!solver->asleep[i]) {
+            RigidBody* rigidBody = RigidBodyComponentArray_GetData(rigidBodyArray, psys->solverBodies[i]);
+            rigidBody->velocity = Vec3_Make(solver->vx[i], solver->vy[i], solver->vz[i]);
+        }
+    }
+}
+
+// Everything one body's integration needs.
+typedef struct {
+    PhysicsSystem* psys;
+    TransformComponentArray* transformArray;
+    RigidBodyComponentArray* rigidBodyArray;
+    GravityComponentArray* gravityArray;
+    float dt;
+    size_t scratchMark;   // Scratch position at the start of the step.
+} PhysicsIntegrateContext;
+
+const KernelAccess PhysicsSystem_IntegrateAccess = {
+    "PhysicsIntegrate",
+    (1u << COMPONENT_TRANSFORM) | (1u << COMPONENT_RIGID_BODY) | (1u << COMPONENT_GRAVITY),
+    (1u << COMPONENT_TRANSFORM) | (1u << COMPONENT_RIGID_BODY),
+    0
+};
+
+// Integrate one body. Sleeping bodies are left alone; a body that falls asleep is
+// queued and leaves the active list after the pass (see EndUpdate).
+ECS_KERNEL(IntegrateBody, PhysicsIntegrateContext) {
+    PhysicsSystem* psys = ctx->psys;
+    float dt = ctx->dt;
+    if (psys->activeIndex[entity] == -1) {
+        return;
+    }
+    if (IsStatic(psys, entity)) {
+        // Never moves: straight to sleep, where it is an obstacle at no cost.
+        if (psys->fallingAsleep) {
+            psys->fallingAsleep[psys->fallingAsleepCount++] = entity;
+        }
+        return;
+    }
+    if (psys->lod) {
+        if (!UpdateLod_IsDue(psys->lod, entity)) {
+            return;
+        }
+        dt = psys->lod->dt[entity];
+    }
+
+    Transform* transform = TransformComponentArray_GetData(ctx->transformArray, entity);
+    RigidBody* rigidBody = RigidBodyComponentArray_GetData(ctx->rigidBodyArray, entity);
+    Gravity* gravity = GravityComponentArray_GetData(ctx->gravityArray, entity);
+
+    // Update the position using the current velocity.
+    transform->position = Vec3_AddScaled(transform->position, rigidBody->velocity, dt);
+
+    // Update the velocity based on gravity (already done when contacts are solved).
+    if (!psys->contactSolver) {
+        rigidBody->velocity = Vec3_AddScaled(rigidBody->velocity, gravity->force, dt);
+    }
+
+    // Rest on the ground plane (or on another body); the body's extent is
+    // approximated by half its largest scale.
+    int resting = psys->contactSolver && psys->supported[entity];
+    if (psys->hasGround) {
+        float bottom = psys->groundHeight + BodyRadius(transform);
+        if (transform->position.y <= bottom + PHYSICS_CONTACT_SLOP) {
+            if (transform->position.y < bottom) {
+                transform->position.y = bottom;
+            }
+            if (rigidBody->velocity.y < -PHYSICS_BOUNCE_THRESHOLD) {
+                rigidBody->velocity.y = -rigidBody->velocity.y * psys->restitution;
+            }
+            else if (rigidBody->velocity.y < 0.0f) {
+                rigidBody->velocity.y = 0.0f;
+            }
+            float damping = 1.0f - psys->friction * dt;
+            if (damping < 0.0f) {
+                damping = 0.0f;
+            }
+            rigidBody->velocity.x *= damping;
+            rigidBody->velocity.z *= damping;
+            resting = 1;
+        }
+    }
+
+    // Sleep once the body has been resting and slow for long enough.
+    float speedSq = Vec3_Dot(rigidBody->velocity, rigidBody->velocity);
+    if (resting && speedSq < PHYSICS_SLEEP_VELOCITY * PHYSICS_SLEEP_VELOCITY) {
+        psys->sleepTimer[entity] += dt;
+        if (psys->sleepTimer[entity] >= PHYSICS_SLEEP_DELAY && psys->fallingAsleep) {
+            rigidBody->velocity = Vec3_Make(0.0f, 0.0f, 0.0f);
+            psys->fallingAsleep[psys->fallingAsleepCount++] = entity;
+        }
+    }
+    else {
+        psys->sleepTimer[entity] = 0.0f;
+    }
+}
+
+ECS_PASS(IntegrateBodies, IntegrateBody, PhysicsIntegrateContext)
+
+// Membership sync, gravity and contacts: everything before the per-body integration.
+static void BeginUpdate(PhysicsSystem* psys, float dt, PhysicsIntegrateContext* ctx) {
+    // Retrieve the component arrays from the ComponentManager.
+    ctx->psys = psys;
+    ctx->transformArray = (TransformComponentArray*)psys->componentManager->componentArrays[COMPONENT_TRANSFORM];
+    ctx->rigidBodyArray = (RigidBodyComponentArray*)psys->componentManager->componentArrays[COMPONENT_RIGID_BODY];
+    ctx->gravityArray = (GravityComponentArray*)psys->componentManager->componentArrays[COMPONENT_GRAVITY];
+    ctx->dt = dt;
+    ctx->scratchMark = Arena_Mark(psys->scratch);
+
+    if (psys->syncedVersion != psys->base.version) {
+        SyncMembership(psys);
+    }
+    if (psys->lod) {
+        // Only awake bodies are bucketed, so a scene at rest costs nothing here either.
+        UpdateLod_BeginFrame(psys->lod, psys->active, psys->activeCount, psys->activeVersion, dt);
+    }
+
+    if (psys->contactSolver) {
+        // Apply gravity first so the solver sees the velocity the step will use.
+        const Entity* bodies = psys->lod ? psys->lod->due : psys->active;
+        int bodyCount = psys->lod ? psys->lod->dueCount : psys->activeCount;
+        for (int i = 0; i < bodyCount; i++) {
+            Entity entity = bodies[i];
+            if (psys->activeIndex[entity] == -1 || IsStatic(psys, entity)) {
+                continue;
+            }
+            RigidBody* rigidBody = RigidBodyComponentArray_GetData(ctx->rigidBodyArray, entity);
+            Gravity* gravity = GravityComponentArray_GetData(ctx->gravityArray, entity);
+            float bodyDt = psys->lod ? psys->lod->dt[entity] : dt;
+            rigidBody->velocity = Vec3_AddScaled(rigidBody->velocity, gravity->force, bodyDt);
+        }
+        ResolveContacts(psys, dt, ctx->transformArray, ctx->rigidBodyArray, ctx->gravityArray);
+    }
+
+    // Only bodies awake now can fall asleep in the pass, each once. If there is no
+    // room they stay awake and try again next step.
+    psys->fallingAsleepCount = 0;
+    psys->fallingAsleep = ARENA_NEW_ARRAY(psys->scratch, Entity, psys->activeCount > 0 ? psys->activeCount : 1);
+    if (!psys->fallingAsleep) {
+        LOG_ERROR("PhysicsSystem: scratch arena is full\n");
+    }
+}
+
+static int CompareEntities(const void* a, const void* b) {
+    Entity x = *(const Entity*)a, y = *(const Entity*)b;
+    return (x > y) - (x < y);
+}
+
+// Put the bodies that fell asleep during the pass to sleep. Entity order, so the
+// active list and the grid come out the same whichever order the pass visited them
+// in, and the next step's contacts are solved in the same order.
+static void EndUpdate(PhysicsSystem* psys, const PhysicsIntegrateContext* ctx) {
+    if (psys->fallingAsleepCount > 1) {
+        qsort(psys->fallingAsleep, (size_t)psys->fallingAsleepCount, sizeof(Entity), CompareEntities);
+    }
+    for (int i = 0; i < psys->fallingAsleepCount; i++) {
+        Entity entity = psys->fallingAsleep[i];
+        const Transform* transform = TransformComponentArray_GetData(ctx->transformArray, entity);
+        RemoveActive(psys, entity);
+        SleepGrid_Insert(&psys->sleepGrid, entity, transform->position, BodyRadius(transform));
+    }
+    psys->fallingAsleep = NULL;
+    psys->fallingAsleepCount = 0;
+    psys->solverBodies = NULL;
+    psys->solverCount = 0;
+    Arena_ResetTo(psys->scratch, ctx->scratchMark);
+}
+
+void PhysicsSystem_Update(PhysicsSystem* psys, float dt) {
+    PhysicsIntegrateContext ctx;
+    BeginUpdate(psys, dt, &ctx);
+
+    if (psys->lod) {
+        // Only this frame's buckets.
+        IntegrateBodies(&ctx, psys->lod->due, psys->lod->dueCount);
+    }
+    else {
+        IntegrateBodies(&ctx, psys->active, psys->activeCount);
     }
+    EndUpdate(psys, &ctx);
 }
@@ -8,17 +8,116 @@
 #include "rigid_body_component.h"
 #include "gravity_component.h"
 #include "System.h"           
+#include "contact_solver.h"
+#include "kernel.h"
+#include "update_lod.h"
+#include "arena.h"
+#include "tags.h"
+
+// Bodies slower than this for PHYSICS_SLEEP_DELAY seconds while resting go to sleep.
+#define PHYSICS_SLEEP_VELOCITY 0.2f
+#define PHYSICS_SLEEP_DELAY 0.5f
+// Distance above the ground that still counts as touching it.
+#define PHYSICS_CONTACT_SLOP 0.05f
+// Impacts slower than this don't bounce, so resting bodies settle instead of jittering.
+#define PHYSICS_BOUNCE_THRESHOLD 1.0f
+// Buckets of the sleeping-body grid.
+#define PHYSICS_GRID_BUCKETS (2 * MAX_ENTITIES)
+
+// Sleeping bodies, kept in a hashed grid from one step to the next so a step only
+// gathers the awake bodies and the sleeping ones within their reach. Cells are at
+// least as wide as the largest body inserted, so a query usually covers 3x3x3 cells.
+typedef struct {
+    int head[PHYSICS_GRID_BUCKETS];
+    int next[MAX_ENTITIES];
+    int prev[MAX_ENTITIES];
+    int bucket[MAX_ENTITIES];         // -1 if the body is not in the grid.
+    Vec3 position[MAX_ENTITIES];      // Where the body fell asleep.
+    float radius[MAX_ENTITIES];
+    Entity entities[MAX_ENTITIES];    // Dense list of the bodies in the grid.
+    int index[MAX_ENTITIES];
+    int count;
+    float cellSize;
+    float maxRadius;                  // Largest radius in the grid.
+} SleepGrid;
 
 // Base System structure.
 typedef struct {
     ECS_System base;  // Contains the entity list and the required signature.
     ComponentManager* componentManager;
+    Arena* scratch;       // Per-step temporaries, released when the step ends.
+
+    // Ground plane (y = groundHeight) that bodies come to rest on.
+    int hasGround;
+    float groundHeight;
+    float restitution;    // Fraction of downward speed kept when bouncing off the ground.
+    float friction;       // Horizontal speed lost per second while touching the ground.
+
+    // Active set: only awake bodies are integrated. activeIndex is -1 for sleeping bodies.
+    Entity active[MAX_ENTITIES];
+    int activeCount;
+    uint32_t activeVersion;            // Bumped whenever the active list changes.
+    int activeIndex[MAX_ENTITIES];
+    float sleepTimer[MAX_ENTITIES];    // Time spent below the sleep velocity while resting.
+    uint32_t memberEpoch[MAX_ENTITIES]; // Sync epoch an entity was last seen as a member, 0 once it left.
+    uint32_t epoch;
+    uint32_t syncedVersion;
+
+    // Optional collision response between bodies (spheres of half the largest scale).
+    // Each step the solver gets the awake bodies and the sleeping ones they reach;
+    // body i of the solver is solverBodies[i].
+    ContactSolver* contactSolver;
+    uint8_t supported[MAX_ENTITIES];   // Pushed on by a contact this step.
+    SleepGrid sleepGrid;
+    Entity* fallingAsleep;             // Bodies that fell asleep during this step's pass (scratch).
+    int fallingAsleepCount;
+    Entity* solverBodies;              // Scratch.
+    int solverCount;
+    int solverSlot[MAX_ENTITIES];      // Index into solverBodies of a gathered sleeper, else -1.
+
+    // Optional update-rate LOD: only bodies due this frame are integrated, each with
+    // its own accumulated dt. Bodies not due are immovable obstacles for contacts.
+    UpdateLod* lod;
+
+    // Bodies tagged TAG_STATIC (NULL: none). They are never integrated or woken and
+    // sleep from their first step on, so they only take part as immovable obstacles.
+    const TagBitset* staticTags;
 } PhysicsSystem;
 
 // Initializes the physics system by setting its required signature and storing the ComponentManager.
-void PhysicsSystem_Init(PhysicsSystem* psys, ComponentManager* cm);
+// Per-step temporaries come from the scratch arena and are given back at the end of
+// each step, so the caller doesn't have to reset it.
+void PhysicsSystem_Init(PhysicsSystem* psys, ComponentManager* cm, Arena* scratch);
 
-// Updates the physics system by applying simple physics (Euler integration) to all entities.
+// Adds a ground plane at the given height.
+void PhysicsSystem_SetGround(PhysicsSystem* psys, float height);
+
+// Resolve contacts between bodies with the given solver (NULL disables it).
+void PhysicsSystem_SetContactSolver(PhysicsSystem* psys, ContactSolver* solver);
+
+// Tick distant bodies less often (NULL ticks every body every frame).
+void PhysicsSystem_SetUpdateLod(PhysicsSystem* psys, UpdateLod* lod);
+
+// Where to look up TAG_STATIC. Without it every body is dynamic.
+void PhysicsSystem_SetStaticTags(PhysicsSystem* psys, const TagBitset* staticTags);
+
+// Updates the physics system by applying simple physics (Euler integration) to all awake entities.
 void PhysicsSystem_Update(PhysicsSystem* psys, float dt);
 
+// What the per-body integration kernel touches.
+extern const KernelAccess PhysicsSystem_IntegrateAccess;
+
+// Wake a sleeping body and the sleeping bodies touching it, which may have rested
+// on it. Call after writing a body's components directly, or after removing its
+// TAG_STATIC. A static body stays asleep, but moves to where its Transform now is.
+void PhysicsSystem_WakeBody(PhysicsSystem* psys, Entity entity);
+
+// Write helpers that wake the body.
+void PhysicsSystem_SetVelocity(PhysicsSystem* psys, Entity entity, Vec3 velocity);
+void PhysicsSystem_ApplyImpulse(PhysicsSystem* psys, Entity entity, Vec3 deltaVelocity);
+void PhysicsSystem_SetPosition(PhysicsSystem* psys, Entity entity, Vec3 position);
+
+// Whether a body is currently asleep.
+int PhysicsSystem_IsSleeping(const PhysicsSystem* psys, Entity entity);
+
 #endif // PHYSICS_SYSTEM_H
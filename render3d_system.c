@@ -2,47 +2,13 @@
 #include "TransformComponent.h"
 #include "coordinator.h"
 #include "components.h"
+#include "math3d.h"
+#include "logger.h"
 #include <math.h>
+#include <string.h>
 
-// Access the global entityColors array from main.c
-extern SDL_Color entityColors[MAX_ENTITIES];
-
-// --- 3D Math Helpers ---
-static inline Vec3 vec3_add(Vec3 a, Vec3 b) {
-    Vec3 result = { a.x + b.x, a.y + b.y, a.z + b.z };
-    return result;
-}
-
-static inline Vec3 vec3_scale(Vec3 v, float s) {
-    Vec3 result = { v.x * s, v.y * s, v.z * s };
-    return result;
-}
-
-// Rotate v around X, then Y, then Z (Euler order X->Y->Z)
-static inline Vec3 vec3_rotate_xyz(Vec3 v, float rx, float ry, float rz) {
-    // Rotate around X
-    float cosX = cosf(rx), sinX = sinf(rx);
-    Vec3 rxV = {
-        v.x,
-        v.y * cosX - v.z * sinX,
-        v.y * sinX + v.z * cosX
-    };
-    // Rotate around Y
-    float cosY = cosf(ry), sinY = sinf(ry);
-    Vec3 rxyV = {
-        rxV.x * cosY + rxV.z * sinY,
-        rxV.y,
-        -rxV.x * sinY + rxV.z * cosY
-    };
-    // Rotate around Z
-    float cosZ = cosf(rz), sinZ = sinf(rz);
-    Vec3 rxyzV = {
-        rxyV.x * cosZ - rxyV.y * sinZ,
-        rxyV.x * sinZ + rxyV.y * cosZ,
-        rxyV.z
-    };
-    return rxyzV;
-}
+// Transforms converted to model matrices per batch.
+#define RENDER3D_BATCH 64
 
 // --- Projection Helper ---
 static inline void projectPoint(const Vec3* point, float fov, float viewerDistance,
@@ -54,21 +20,16 @@ static inline void projectPoint(const Vec3* point, float fov, float viewerDistan
     *outY = point->y * factor;
 }
 
-// A cube has 8 corners -> 12 triangles -> 36 indices
-// We'll define them in (triangle list) form, each face as two triangles:
-static const int cubeIndices[36] = {
-    // Back face (0,1,2,3)
-    0,1,2, 2,3,0,
-    // Front face (4,5,6,7)
-    4,5,6, 6,7,4,
-    // Left face (0,3,7,4)
-    0,3,7, 7,4,0,
-    // Right face (1,2,6,5)
-    1,2,6, 6,5,1,
-    // Top face (3,2,6,7)
-    3,2,6, 6,7,3,
-    // Bottom face (0,1,5,4)
-    0,1,5, 5,4,0
+// A cube has 8 corners -> 6 faces -> 12 triangles.
+// Each face is wound so that (v1 - v0) x (v2 - v0) points into the cube; after
+// projection (screen y points down) a face toward the viewer has negative area.
+static const int cubeFaces[6][4] = {
+    { 0, 1, 2, 3 }, // Back face (z = -0.5)
+    { 4, 7, 6, 5 }, // Front face (z = +0.5)
+    { 0, 3, 7, 4 }, // Left face (x = -0.5)
+    { 1, 5, 6, 2 }, // Right face (x = +0.5)
+    { 3, 2, 6, 7 }, // Top face (y = +0.5)
+    { 0, 4, 5, 1 }  // Bottom face (y = -0.5)
 };
 
 // Local positions for a unit cube from -0.5..0.5 in each axis
@@ -83,57 +44,73 @@ static const Vec3 localCubeVerts[8] = {
     { -0.5f,  0.5f,  0.5f }  // 7
 };
 
-// Renders a solid cube by sending transformed vertices to SDL_RenderGeometry
-static void renderSolidCube(SDL_Renderer* renderer,
-    Vec3 center,
-    float rotX, float rotY, float rotZ,
-    float scale,
-    SDL_Color color,
-    float fov, float viewerDistance,
-    int screenWidth, int screenHeight)
+// Transform and project the 8 corners of a cube. Returns 0 if any corner is behind
+// the viewer, in which case the cube is skipped.
+static int projectCube(const Mat3x4* model, float fov, float viewerDistance,
+    int screenWidth, int screenHeight, SoftRasterVertex* projected)
 {
-    // Transform and project each of the 8 corners
-    SDL_Vertex vertices[8];
-
+    Vec3 worldVerts[8];
     float aspect = (float)screenWidth / (float)screenHeight;
 
+    // Scale, rotate and translate all corners at once.
+    Mat4 m = Mat4_FromMat3x4(model);
+    Math3D_TransformPoints(&m, localCubeVerts, worldVerts, 8);
+
     for (int i = 0; i < 8; i++) {
-        // Start with the local vertex
-        Vec3 v = localCubeVerts[i];
-        // Apply uniform scale.
-        v.x *= scale; v.y *= scale; v.z *= scale;
-
-        // Rotate around X axis.
-        {
-            float cosX = cosf(rotX), sinX = sinf(rotX);
-            float y = v.y * cosX - v.z * sinX;
-            float z = v.y * sinX + v.z * cosX;
-            v.y = y; v.z = z;
-        }
-        // Rotate around Y axis.
-        {
-            float cosY = cosf(rotY), sinY = sinf(rotY);
-            float x = v.x * cosY + v.z * sinY;
-            float z = -v.x * sinY + v.z * cosY;
-            v.x = x; v.z = z;
-        }
-        // Rotate around Z axis.
-        {
-            float cosZ = cosf(rotZ), sinZ = sinf(rotZ);
-            float x = v.x * cosZ - v.y * sinZ;
-            float y = v.x * sinZ + v.y * cosZ;
-            v.x = x; v.y = y;
+        float depth = viewerDistance + worldVerts[i].z;
+        if (depth <= 0.0f) {
+            return 0;
         }
-        // Translate to the cube's center.
-        v = (Vec3){ v.x + center.x, v.y + center.y, v.z + center.z };
-
         // Project to 2D using the updated projectPoint.
         float projX, projY;
-        projectPoint(&v, fov, viewerDistance, aspect, &projX, &projY);
-        vertices[i].position.x = projX + screenWidth / 2.0f;
-        vertices[i].position.y = -projY + screenHeight / 2.0f;
+        projectPoint(&worldVerts[i], fov, viewerDistance, aspect, &projX, &projY);
+        projected[i].x = projX + screenWidth / 2.0f;
+        projected[i].y = -projY + screenHeight / 2.0f;
+        projected[i].depth = depth;
+    }
+    return 1;
+}
 
-        // Convert SDL_Color (0255) to SDL_FColor (01).
+// Build the triangle list for the faces of a projected cube that face the viewer.
+// Returns the number of indices written (at most 18: three faces).
+static int buildVisibleFaces(const SoftRasterVertex* v, int* indices) {
+    int count = 0;
+    for (int f = 0; f < 6; f++) {
+        const int* face = cubeFaces[f];
+        float ax = v[face[1]].x - v[face[0]].x, ay = v[face[1]].y - v[face[0]].y;
+        float bx = v[face[2]].x - v[face[0]].x, by = v[face[2]].y - v[face[0]].y;
+        if (ax * by - ay * bx >= 0.0f) {
+            continue; // Facing away (or edge-on).
+        }
+        indices[count++] = face[0]; indices[count++] = face[1]; indices[count++] = face[2];
+        indices[count++] = face[2]; indices[count++] = face[3]; indices[count++] = face[0];
+    }
+    return count;
+}
+
+// Renders the visible faces of a projected cube to the target: SDL_RenderGeometry,
+// or the software rasterizer.
+static int renderSolidCube(const Render3DTarget* target,
+    const SoftRasterVertex* projected,
+    SDL_Color color)
+{
+    int indices[18];
+    int indexCount = buildVisibleFaces(projected, indices);
+    if (indexCount == 0) {
+        return 0;
+    }
+
+    if (target->raster) {
+        SoftRaster_SubmitTriangles(target->raster, projected, indices, indexCount, color);
+        return indexCount / 3;
+    }
+
+    SDL_Vertex vertices[8];
+    for (int i = 0; i < 8; i++) {
+        vertices[i].position.x = projected[i].x;
+        vertices[i].position.y = projected[i].y;
+
+        // Convert SDL_Color (0-255) to SDL_FColor (0-1).
         vertices[i].color.r = color.r / 255.0f;
         vertices[i].color.g = color.g / 255.0f;
         vertices[i].color.b = color.b / 255.0f;
@@ -143,53 +120,148 @@ static void renderSolidCube(SDL_Renderer* renderer,
         vertices[i].tex_coord.y = 0;
     }
 
-    SDL_RenderGeometry(renderer, NULL, vertices, 8, cubeIndices, 36);
+    SDL_RenderGeometry(target->renderer, NULL, vertices, 8, indices, indexCount);
+    return indexCount / 3;
+}
 
+// Map a float to an unsigned key with the same ordering.
+static inline uint32_t depthSortKey(float depth) {
+    uint32_t bits;
+    memcpy(&bits, &depth, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+// LSD radix sort of (key, value) pairs, 8 bits per pass. The result ends up in
+// keys[0]/values[0]. Passes where every key shares the digit are skipped.
+static void radixSortByKey(uint32_t* keys[2], int* values[2], int n) {
+    int src = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        int histogram[256] = { 0 };
+        for (int i = 0; i < n; i++) {
+            histogram[(keys[src][i] >> shift) & 0xFF]++;
+        }
+        if (histogram[(keys[src][0] >> shift) & 0xFF] == n) {
+            continue;
+        }
+        int offset = 0;
+        for (int d = 0; d < 256; d++) {
+            int c = histogram[d];
+            histogram[d] = offset;
+            offset += c;
+        }
+        int dst = src ^ 1;
+        for (int i = 0; i < n; i++) {
+            int pos = histogram[(keys[src][i] >> shift) & 0xFF]++;
+            keys[dst][pos] = keys[src][i];
+            values[dst][pos] = values[src][i];
+        }
+        src = dst;
+    }
+    if (src != 0) {
+        memcpy(keys[0], keys[1], (size_t)n * sizeof(uint32_t));
+        memcpy(values[0], values[1], (size_t)n * sizeof(int));
+    }
 }
 
 // --- Render3DSystem Functions ---
-void Render3DSystem_Init(Render3DSystem* r3dSys, ComponentManager* cm) {
+void Render3DSystem_Init(Render3DSystem* r3dSys, ComponentManager* cm, Arena* scratch, const SDL_Color* colors) {
     // Only requires the Transform component
-    r3dSys->base.count = 0;
+    ECS_System_Init(&r3dSys->base, "Render3D");
     r3dSys->base.requiredSignature = (1 << COMPONENT_TRANSFORM);
     r3dSys->componentManager = cm;
+    r3dSys->scratch = scratch;
+    r3dSys->colors = colors;
+    r3dSys->cubeCount = 0;
+    r3dSys->trianglesSubmitted = 0;
 }
 
 void Render3DSystem_Update(Render3DSystem* r3dSys, float dt,
     SDL_Renderer* renderer,
     int screenWidth, int screenHeight)
 {
-    // Increase the FOV and distance to spread out the view
-    float fov = 300.0f;        // bigger FOV => more perspective spread
-    float viewerDistance = 5.0f;
+    (void)dt; // Drawing doesn't depend on time.
+    Render3DTarget target = { renderer, NULL, screenWidth, screenHeight };
+    Render3DSystem_Draw(r3dSys, &target);
+}
 
+void Render3DSystem_Draw(Render3DSystem* r3dSys, const Render3DTarget* target)
+{
     // Access the Transform array
     TransformComponentArray* transformArray =
         (TransformComponentArray*)r3dSys->componentManager->componentArrays[COMPONENT_TRANSFORM];
 
-    // For each entity
-    for (int i = 0; i < r3dSys->base.count; i++) {
+    // Gather this frame's transforms and colors in entity-list order.
+    int count = r3dSys->base.count;
+    int capacity = count > 0 ? count : 1;
+    Transform* transforms = ARENA_NEW_ARRAY(r3dSys->scratch, Transform, capacity);
+    SDL_Color* colors = ARENA_NEW_ARRAY(r3dSys->scratch, SDL_Color, capacity);
+    if (!transforms || !colors) {
+        LOG_ERROR("Render3DSystem: frame scratch arena is full\n");
+        r3dSys->cubeCount = 0;
+        r3dSys->trianglesSubmitted = 0;
+        return;
+    }
+    for (int i = 0; i < count; i++) {
         Entity entity = r3dSys->base.entities[i];
-        Transform* t = TransformComponentArray_GetData(transformArray, entity);
-        if (t) {
-            // Unpack transform
-            Vec3 center = { t->position.x, t->position.y, t->position.z };
-            float rotX = t->rotation.x;
-            float rotY = t->rotation.y;
-            float rotZ = t->rotation.z;
-            float scale = t->scale.x; // uniform scale
-
-            // Use that entity's color
-            SDL_Color color = entityColors[entity];
-
-            // Render the solid cube
-            renderSolidCube(renderer,
-                center,
-                rotX, rotY, rotZ,
-                scale,
-                color,
-                fov, viewerDistance,
-                screenWidth, screenHeight);
+        transforms[i] = *TransformComponentArray_GetData(transformArray, entity);
+        // Use that entity's color
+        colors[i] = r3dSys->colors[entity];
+    }
+    Render3DSystem_DrawTransforms(r3dSys, transforms, colors, count, target);
+}
+
+void Render3DSystem_DrawTransforms(Render3DSystem* r3dSys, const Transform* transforms,
+    const SDL_Color* colors, int count, const Render3DTarget* target)
+{
+    // Increase the FOV and distance to spread out the view
+    float fov = 300.0f;        // bigger FOV => more perspective spread
+    float viewerDistance = 5.0f;
+
+    // Working set for this frame; the sort ping-pongs between two key/order buffers.
+    int capacity = count > 0 ? count : 1;
+    Render3DCube* cubes = ARENA_NEW_ARRAY(r3dSys->scratch, Render3DCube, capacity);
+    uint32_t* keys[2] = { ARENA_NEW_ARRAY(r3dSys->scratch, uint32_t, capacity), ARENA_NEW_ARRAY(r3dSys->scratch, uint32_t, capacity) };
+    int* order[2] = { ARENA_NEW_ARRAY(r3dSys->scratch, int, capacity), ARENA_NEW_ARRAY(r3dSys->scratch, int, capacity) };
+    if (!cubes || !keys[0] || !keys[1] || !order[0] || !order[1]) {
+        LOG_ERROR("Render3DSystem: frame scratch arena is full\n");
+        r3dSys->cubeCount = 0;
+        r3dSys->trianglesSubmitted = 0;
+        return;
+    }
+
+    // Build model matrices in batches and project every cube.
+    Mat3x4 models[RENDER3D_BATCH];
+    int cubeCount = 0;
+
+    for (int first = 0; first < count; first += RENDER3D_BATCH) {
+        int n = count - first;
+        if (n > RENDER3D_BATCH) {
+            n = RENDER3D_BATCH;
+        }
+        Math3D_TransformToMat3x4Batch(&transforms[first], models, n);
+
+        for (int i = 0; i < n; i++) {
+            Render3DCube* cube = &cubes[cubeCount];
+            if (!projectCube(&models[i], fov, viewerDistance, target->width, target->height, cube->corners)) {
+                continue;
+            }
+            cube->color = colors[first + i];
+            keys[0][cubeCount] = depthSortKey(viewerDistance + transforms[first + i].position.z);
+            order[0][cubeCount] = cubeCount;
+            cubeCount++;
         }
     }
+    r3dSys->cubeCount = cubeCount;
+
+    // Painter's order: sort by view depth and draw back to front.
+    if (cubeCount > 1) {
+        radixSortByKey(keys, order, cubeCount);
+    }
+
+    int triangles = 0;
+    for (int i = cubeCount - 1; i >= 0; i--) {
+        const Render3DCube* cube = &cubes[order[0][i]];
+        triangles += renderSolidCube(target, cube->corners, cube->color);
+    }
+    r3dSys->trianglesSubmitted = triangles;
 }
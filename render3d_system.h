@@ -6,20 +6,55 @@
 #include "ComponentManager.h"
 #include "ComponentTypes.h"
 #include "SDL3/SDL.h"
+#include "soft_raster.h"
+#include "arena.h"
 #include <math.h>
 
+// A cube projected to the screen this frame.
+typedef struct {
+    SoftRasterVertex corners[8];
+    SDL_Color color;
+} Render3DCube;
+
 // Render3DSystem structure that holds a base ECS_System and a pointer to the ComponentManager.
 typedef struct {
     ECS_System base;            // Contains the list of entities and required signature.
     ComponentManager* componentManager;
+    const SDL_Color* colors;    // Per-entity colors, indexed by entity.
     // You could add more fields here for projection settings, etc.
+
+    // Per-frame working set (projected cubes and their depth sort) comes from this
+    // scratch arena; it stays valid until the arena is reset.
+    Arena* scratch;
+    int cubeCount;
+    int trianglesSubmitted;     // Triangles sent to the backend last frame.
 } Render3DSystem;
 
-// Initialize the Render3DSystem with the ComponentManager.
-void Render3DSystem_Init(Render3DSystem* r3dSys, ComponentManager* cm);
+// Where the cubes are drawn: through an SDL_Renderer, or into a SoftRaster when
+// running without a display. Set exactly one of renderer/raster.
+typedef struct {
+    SDL_Renderer* renderer;
+    SoftRaster* raster;
+    int width;
+    int height;
+} Render3DTarget;
 
-// Update the Render3DSystem: for each entity, render a 3D wireframe cube.
+// Initialize the Render3DSystem with the ComponentManager, a per-frame scratch arena and
+// the world's entity colors.
+void Render3DSystem_Init(Render3DSystem* r3dSys, ComponentManager* cm, Arena* scratch, const SDL_Color* colors);
+
+// Update the Render3DSystem: for each entity, render a solid cube. Faces pointing away
+// from the viewer are culled and cubes are drawn back to front.
 // The renderer, dt, and screen parameters are passed in.
 void Render3DSystem_Update(Render3DSystem* r3dSys, float dt, SDL_Renderer* renderer, int screenWidth, int screenHeight);
 
+// Same as Render3DSystem_Update, for any target. With a SoftRaster the triangles are
+// only queued; SoftRaster_EndFrame rasterizes them.
+void Render3DSystem_Draw(Render3DSystem* r3dSys, const Render3DTarget* target);
+
+// Draw count cubes from plain arrays instead of the component arrays, e.g. from a
+// snapshot taken by another thread. Touches no ECS state.
+void Render3DSystem_DrawTransforms(Render3DSystem* r3dSys, const Transform* transforms,
+    const SDL_Color* colors, int count, const Render3DTarget* target);
+
 #endif // RENDER3D_SYSTEM_H
@@ -0,0 +1,238 @@
+#include "replay.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// File layout (little endian):
+//   "ECSR" u32 version, u32 seed, f32 dt, u32 spawnCount, u32 inputCount, u32 frameCount
+//   inputs:    varint frame delta, u8 type, varint entity, 3 x f32 value
+//   checksums: u32 per frame
+#define REPLAY_MAGIC "ECSR"
+#define REPLAY_VERSION 1u
+
+void ReplayLog_Init(ReplayLog* log, uint32_t seed, float dt, uint32_t spawnCount) {
+    memset(log, 0, sizeof(*log));
+    log->seed = seed;
+    log->dt = dt;
+    log->spawnCount = spawnCount;
+}
+
+void ReplayLog_Free(ReplayLog* log) {
+    free(log->inputs);
+    free(log->checksums);
+    log->inputs = NULL;
+    log->checksums = NULL;
+    log->inputCount = log->inputCapacity = 0;
+    log->frameCount = log->frameCapacity = 0;
+}
+
+// Grow *array to hold at least needed elements. Returns 0 on success.
+static int Reserve(void** array, int* capacity, int needed, size_t elementSize) {
+    if (needed <= *capacity) {
+        return 0;
+    }
+    int grown = *capacity > 0 ? *capacity * 2 : 1024;
+    while (grown < needed) {
+        grown *= 2;
+    }
+    void* memory = realloc(*array, (size_t)grown * elementSize);
+    if (!memory) {
+        return -1;
+    }
+    *array = memory;
+    *capacity = grown;
+    return 0;
+}
+
+int ReplayLog_AddInput(ReplayLog* log, const InputEvent* input) {
+    if (log->inputCount > 0 && input->frame < log->inputs[log->inputCount - 1].frame) {
+        return -1;
+    }
+    if (Reserve((void**)&log->inputs, &log->inputCapacity, log->inputCount + 1, sizeof(InputEvent)) != 0) {
+        return -1;
+    }
+    log->inputs[log->inputCount++] = *input;
+    return 0;
+}
+
+int ReplayLog_AddChecksum(ReplayLog* log, uint32_t checksum) {
+    if (Reserve((void**)&log->checksums, &log->frameCapacity, log->frameCount + 1, sizeof(uint32_t)) != 0) {
+        return -1;
+    }
+    log->checksums[log->frameCount++] = checksum;
+    return 0;
+}
+
+// --- Serialization helpers ---
+
+static void PutU32(FILE* f, uint32_t v) {
+    uint8_t b[4] = { (uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24) };
+    fwrite(b, 1, 4, f);
+}
+
+static void PutF32(FILE* f, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    PutU32(f, bits);
+}
+
+static void PutVarint(FILE* f, uint32_t v) {
+    while (v >= 0x80) {
+        fputc((int)((v & 0x7F) | 0x80), f);
+        v >>= 7;
+    }
+    fputc((int)v, f);
+}
+
+static int GetU32(FILE* f, uint32_t* v) {
+    uint8_t b[4];
+    if (fread(b, 1, 4, f) != 4) {
+        return -1;
+    }
+    *v = (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+    return 0;
+}
+
+static int GetF32(FILE* f, float* v) {
+    uint32_t bits;
+    if (GetU32(f, &bits) != 0) {
+        return -1;
+    }
+    memcpy(v, &bits, sizeof(*v));
+    return 0;
+}
+
+static int GetVarint(FILE* f, uint32_t* v) {
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        int c = fgetc(f);
+        if (c == EOF) {
+            return -1;
+        }
+        value |= (uint32_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) {
+            *v = value;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int ReplayLog_Save(const ReplayLog* log, const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return -1;
+    }
+    fwrite(REPLAY_MAGIC, 1, 4, f);
+    PutU32(f, REPLAY_VERSION);
+    PutU32(f, log->seed);
+    PutF32(f, log->dt);
+    PutU32(f, log->spawnCount);
+    PutU32(f, (uint32_t)log->inputCount);
+    PutU32(f, (uint32_t)log->frameCount);
+
+    uint32_t previousFrame = 0;
+    for (int i = 0; i < log->inputCount; i++) {
+        const InputEvent* input = &log->inputs[i];
+        PutVarint(f, input->frame - previousFrame);
+        previousFrame = input->frame;
+        fputc(input->type, f);
+        PutVarint(f, input->entity);
+        PutF32(f, input->value.x);
+        PutF32(f, input->value.y);
+        PutF32(f, input->value.z);
+    }
+    for (int i = 0; i < log->frameCount; i++) {
+        PutU32(f, log->checksums[i]);
+    }
+    int failed = ferror(f);
+    if (fclose(f) != 0) {
+        failed = 1;
+    }
+    return failed ? -1 : 0;
+}
+
+int ReplayLog_Load(ReplayLog* log, const char* path) {
+    memset(log, 0, sizeof(*log));
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return -1;
+    }
+    char magic[4];
+    uint32_t version = 0, inputCount = 0, frameCount = 0;
+    int failed = fread(magic, 1, 4, f) != 4 || memcmp(magic, REPLAY_MAGIC, 4) != 0 ||
+        GetU32(f, &version) != 0 || version != REPLAY_VERSION ||
+        GetU32(f, &log->seed) != 0 || GetF32(f, &log->dt) != 0 || GetU32(f, &log->spawnCount) != 0 ||
+        GetU32(f, &inputCount) != 0 || GetU32(f, &frameCount) != 0;
+
+    uint32_t frame = 0;
+    for (uint32_t i = 0; !failed && i < inputCount; i++) {
+        InputEvent input;
+        uint32_t delta, entity;
+        int type = 0;
+        failed = GetVarint(f, &delta) != 0 || (type = fgetc(f)) == EOF || GetVarint(f, &entity) != 0 ||
+            GetF32(f, &input.value.x) != 0 || GetF32(f, &input.value.y) != 0 || GetF32(f, &input.value.z) != 0;
+        if (!failed) {
+            frame += delta;
+            input.frame = frame;
+            input.type = (uint8_t)type;
+            input.entity = entity;
+            failed = ReplayLog_AddInput(log, &input) != 0;
+        }
+    }
+    for (uint32_t i = 0; !failed && i < frameCount; i++) {
+        uint32_t checksum;
+        failed = GetU32(f, &checksum) != 0 || ReplayLog_AddChecksum(log, checksum) != 0;
+    }
+    fclose(f);
+    if (failed) {
+        ReplayLog_Free(log);
+        return -1;
+    }
+    return 0;
+}
+
+// --- Player ---
+
+int Replay_Play(const ReplayLog* log, JobSystem* jobs, int keepGoing, ReplayResult* result) {
+    memset(result, 0, sizeof(*result));
+    result->firstMismatch = -1;
+
+    WorldConfig config;
+    WorldConfig_Default(&config);
+    config.jobs = jobs;
+    config.seed = log->seed;
+    config.loadModules = 0;
+    World* world = malloc(sizeof(World));
+    if (!world || World_Init(world, &config) != 0) {
+        free(world);
+        return -1;
+    }
+    World_SpawnFallingBlocks(world, (int)log->spawnCount);
+
+    int nextInput = 0;
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int frame = 0; frame < log->frameCount; frame++) {
+        while (nextInput < log->inputCount && log->inputs[nextInput].frame <= world->frame) {
+            World_ApplyInput(world, &log->inputs[nextInput++]);
+        }
+        World_Step(world, log->dt);
+        result->framesPlayed++;
+
+        uint32_t checksum = World_Checksum(world);
+        if (checksum != log->checksums[frame] && result->firstMismatch < 0) {
+            result->firstMismatch = frame;
+            result->expected = log->checksums[frame];
+            result->actual = checksum;
+            if (!keepGoing) {
+                break;
+            }
+        }
+    }
+    result->totalMs = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+
+    World_Destroy(world);
+    free(world);
+    return 0;
+}
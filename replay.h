@@ -0,0 +1,50 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include "world.h"
+#include "job_system.h"
+
+// A recorded session: what is needed to rebuild the world (seed, step, scene size),
+// the external inputs in frame order, and a checksum of the world after each frame.
+typedef struct {
+    uint32_t seed;
+    float dt;
+    uint32_t spawnCount;
+
+    InputEvent* inputs;
+    int inputCount;
+    int inputCapacity;
+
+    uint32_t* checksums;      // One per frame; frame i is the state after step i.
+    int frameCount;
+    int frameCapacity;
+} ReplayLog;
+
+// Result of playing a log back.
+typedef struct {
+    int framesPlayed;
+    int firstMismatch;        // First frame whose checksum differs, -1 if none.
+    uint32_t expected;        // Checksums at firstMismatch.
+    uint32_t actual;
+    double totalMs;           // Wall time for all steps.
+} ReplayResult;
+
+void ReplayLog_Init(ReplayLog* log, uint32_t seed, float dt, uint32_t spawnCount);
+void ReplayLog_Free(ReplayLog* log);
+
+// Append an input (frames must not decrease) or the checksum of the next frame.
+// Return 0 on success.
+int ReplayLog_AddInput(ReplayLog* log, const InputEvent* input);
+int ReplayLog_AddChecksum(ReplayLog* log, uint32_t checksum);
+
+// Binary file I/O. Return 0 on success.
+int ReplayLog_Save(const ReplayLog* log, const char* path);
+int ReplayLog_Load(ReplayLog* log, const char* path);
+
+// Rebuild the world from the log and re-simulate every frame as fast as possible,
+// feeding the recorded inputs and comparing checksums. Stops at the first mismatch
+// unless keepGoing is set. Returns 0 if the world could be created.
+int Replay_Play(const ReplayLog* log, JobSystem* jobs, int keepGoing, ReplayResult* result);
+
+#endif // REPLAY_H
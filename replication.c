@@ -0,0 +1,552 @@
+#include "replication.h"
+#include "math3d.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Per-entity change mask.
+#define REPL_FIELD_REMOVED 0x01
+#define REPL_FIELD_POSITION 0x02
+#define REPL_FIELD_ROTATION 0x04
+#define REPL_FIELD_SCALE 0x08
+#define REPL_FIELD_VELOCITY 0x10
+#define REPL_FIELD_BITS 5
+
+static const ReplState kEmptyState = { { 0, 0, 0 }, 0, { 0, 0, 0 }, { 0, 0, 0 }, 0 };
+
+// --- Bit packing (LSB first) ---
+
+typedef struct {
+    uint8_t* data;
+    int capacity;
+    int size;
+    uint64_t bits;
+    int bitCount;
+    int overflow;
+} BitWriter;
+
+typedef struct {
+    const uint8_t* data;
+    int size;
+    int pos;
+    uint64_t bits;
+    int bitCount;
+    int error;
+} BitReader;
+
+static void BitWriter_Write(BitWriter* w, uint32_t value, int count) {
+    if (count < 32) {
+        value &= (1u << count) - 1u;
+    }
+    w->bits |= (uint64_t)value << w->bitCount;
+    w->bitCount += count;
+    while (w->bitCount >= 8) {
+        if (w->size < w->capacity) {
+            w->data[w->size++] = (uint8_t)w->bits;
+        }
+        else {
+            w->overflow = 1;
+        }
+        w->bits >>= 8;
+        w->bitCount -= 8;
+    }
+}
+
+static void BitWriter_Flush(BitWriter* w) {
+    if (w->bitCount > 0) {
+        BitWriter_Write(w, 0, 8 - w->bitCount);
+    }
+}
+
+static uint32_t BitReader_Read(BitReader* r, int count) {
+    while (r->bitCount < count) {
+        if (r->pos >= r->size) {
+            r->error = 1;
+            return 0;
+        }
+        r->bits |= (uint64_t)r->data[r->pos++] << r->bitCount;
+        r->bitCount += 8;
+    }
+    uint32_t value = (uint32_t)(r->bits & ((count < 32) ? ((1ull << count) - 1ull) : 0xFFFFFFFFull));
+    r->bits >>= count;
+    r->bitCount -= count;
+    return value;
+}
+
+// Unsigned value as a 6-bit length followed by that many bits, so small numbers
+// (typical frame-to-frame deltas) stay small.
+static void WriteVar(BitWriter* w, uint32_t value) {
+    int length = 0;
+    while (length < 32 && (value >> length) != 0) {
+        length++;
+    }
+    BitWriter_Write(w, (uint32_t)length, 6);
+    if (length > 0) {
+        BitWriter_Write(w, value, length);
+    }
+}
+
+static uint32_t ReadVar(BitReader* r) {
+    int length = (int)BitReader_Read(r, 6);
+    if (length > 32) {
+        r->error = 1;
+        return 0;
+    }
+    return length > 0 ? BitReader_Read(r, length) : 0;
+}
+
+// Signed deltas are zigzag coded so small negative values are short too.
+static void WriteDelta(BitWriter* w, int32_t delta) {
+    WriteVar(w, ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+}
+
+static int32_t ReadDelta(BitReader* r) {
+    uint32_t value = ReadVar(r);
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1u);
+}
+
+// --- Quantization ---
+
+static inline int32_t Quantize(float value) {
+    return (int32_t)lroundf(value * REPL_QUANTIZE);
+}
+
+static inline float Dequantize(int32_t value) {
+    return (float)value / REPL_QUANTIZE;
+}
+
+#define REPL_QUAT_RANGE 0.70710678f  // Non-largest components lie in [-1/sqrt2, 1/sqrt2].
+
+// Smallest-three: drop the largest component (recoverable from unit length) and send
+// the other three in 10 bits each.
+static uint32_t PackRotation(Quat q) {
+    float c[4] = { q.x, q.y, q.z, q.w };
+    int largest = 0;
+    for (int i = 1; i < 4; i++) {
+        if (fabsf(c[i]) > fabsf(c[largest])) {
+            largest = i;
+        }
+    }
+    float sign = c[largest] < 0.0f ? -1.0f : 1.0f;
+    uint32_t packed = (uint32_t)largest;
+    for (int i = 0; i < 4; i++) {
+        if (i == largest) {
+            continue;
+        }
+        float normalized = (c[i] * sign / REPL_QUAT_RANGE) * 0.5f + 0.5f;
+        long q10 = lroundf(normalized * 1023.0f);
+        if (q10 < 0) q10 = 0;
+        if (q10 > 1023) q10 = 1023;
+        packed = (packed << 10) | (uint32_t)q10;
+    }
+    return packed;
+}
+
+static Quat UnpackRotation(uint32_t packed) {
+    float c[4];
+    int largest = (int)(packed >> 30);
+    float sumSq = 0.0f;
+    for (int i = 3; i >= 0; i--) {
+        if (i == largest) {
+            continue;
+        }
+        c[i] = ((float)(packed & 1023u) / 1023.0f - 0.5f) * 2.0f * REPL_QUAT_RANGE;
+        sumSq += c[i] * c[i];
+        packed >>= 10;
+    }
+    c[largest] = sqrtf(sumSq < 1.0f ? 1.0f - sumSq : 0.0f);
+    Quat q = { c[0], c[1], c[2], c[3] };
+    return q;
+}
+
+static void QuantizeTransform(const Transform* t, ReplState* s) {
+    s->position[0] = Quantize(t->position.x);
+    s->position[1] = Quantize(t->position.y);
+    s->position[2] = Quantize(t->position.z);
+    s->rotation = PackRotation(t->rotation);
+    s->scale[0] = Quantize(t->scale.x);
+    s->scale[1] = Quantize(t->scale.y);
+    s->scale[2] = Quantize(t->scale.z);
+    s->flags = REPL_PRESENT;
+}
+
+// --- History ---
+
+static int AllocHistory(ReplState** history) {
+    for (int i = 0; i < REPL_HISTORY; i++) {
+        history[i] = calloc(MAX_ENTITIES, sizeof(ReplState));
+        if (!history[i]) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void FreeHistory(ReplState** history) {
+    for (int i = 0; i < REPL_HISTORY; i++) {
+        free(history[i]);
+        history[i] = NULL;
+    }
+}
+
+// --- Encoder ---
+
+int ReplicationEncoder_Init(ReplicationEncoder* enc) {
+    memset(enc, 0, sizeof(*enc));
+    enc->nextSeq = 1;
+    if (AllocHistory(enc->history) != 0) {
+        ReplicationEncoder_Shutdown(enc);
+        return -1;
+    }
+    return 0;
+}
+
+void ReplicationEncoder_Shutdown(ReplicationEncoder* enc) {
+    FreeHistory(enc->history);
+}
+
+void ReplicationEncoder_Ack(ReplicationEncoder* enc, uint32_t seq) {
+    if (seq > enc->ackedSeq && seq < enc->nextSeq) {
+        enc->ackedSeq = seq;
+    }
+}
+
+const ReplState* ReplicationEncoder_GetSent(const ReplicationEncoder* enc, uint32_t seq, Entity entity) {
+    int slot = (int)(seq % REPL_HISTORY);
+    if (seq == 0 || entity >= MAX_ENTITIES || enc->historySeq[slot] != seq) {
+        return NULL;
+    }
+    return &enc->history[slot][entity];
+}
+
+int ReplicationEncoder_Encode(ReplicationEncoder* enc, const TransformComponentArray* transforms,
+    const RigidBodyComponentArray* rigidBodies, uint8_t* out, int capacity)
+{
+    uint32_t seq = enc->nextSeq++;
+    int slot = (int)(seq % REPL_HISTORY);
+
+    // Diff against the newest acknowledged frame if it is still in the history.
+    const ReplState* baseline = NULL;
+    if (enc->ackedSeq != 0 && seq - enc->ackedSeq < REPL_HISTORY &&
+        enc->historySeq[enc->ackedSeq % REPL_HISTORY] == enc->ackedSeq) {
+        baseline = enc->history[enc->ackedSeq % REPL_HISTORY];
+    }
+
+    // Quantize the current state straight from the dense arrays.
+    ReplState* current = enc->history[slot];
+    memset(current, 0, (size_t)enc->entityLimit * sizeof(ReplState));
+    for (size_t i = 0; i < transforms->size; i++) {
+        Entity entity = transforms->indexToEntityMap[i];
+        QuantizeTransform(&transforms->components[i], &current[entity]);
+        if ((int)entity >= enc->entityLimit) {
+            enc->entityLimit = (int)entity + 1;
+        }
+    }
+    if (rigidBodies) {
+        for (size_t i = 0; i < rigidBodies->size; i++) {
+            ReplState* s = &current[rigidBodies->indexToEntityMap[i]];
+            if (s->flags & REPL_PRESENT) {
+                const Vec3* v = &rigidBodies->components[i].velocity;
+                s->velocity[0] = Quantize(v->x);
+                s->velocity[1] = Quantize(v->y);
+                s->velocity[2] = Quantize(v->z);
+                s->flags |= REPL_HAS_VELOCITY;
+            }
+        }
+    }
+    enc->historySeq[slot] = seq;
+
+    BitWriter w = { out, capacity, 0, 0, 0, 0 };
+    BitWriter_Write(&w, seq, 32);
+    BitWriter_Write(&w, baseline ? 1u : 0u, 1);
+    if (baseline) {
+        BitWriter_Write(&w, enc->ackedSeq, 32);
+    }
+
+    int changed = 0;
+    int previous = -1;
+    for (int entity = 0; entity < enc->entityLimit; entity++) {
+        const ReplState* c = &current[entity];
+        const ReplState* b = baseline ? &baseline[entity] : &kEmptyState;
+        int inCurrent = c->flags & REPL_PRESENT;
+        int inBaseline = b->flags & REPL_PRESENT;
+        if (!inCurrent && !inBaseline) {
+            continue;
+        }
+        const ReplState* ref = inBaseline ? b : &kEmptyState;
+
+        uint32_t mask = 0;
+        if (!inCurrent) {
+            mask = REPL_FIELD_REMOVED;
+        }
+        else {
+            if (!inBaseline || memcmp(c->position, ref->position, sizeof(c->position)) != 0) mask |= REPL_FIELD_POSITION;
+            if (!inBaseline || c->rotation != ref->rotation) mask |= REPL_FIELD_ROTATION;
+            if (!inBaseline || memcmp(c->scale, ref->scale, sizeof(c->scale)) != 0) mask |= REPL_FIELD_SCALE;
+            if (!inBaseline || (c->flags & REPL_HAS_VELOCITY) != (ref->flags & REPL_HAS_VELOCITY) ||
+                memcmp(c->velocity, ref->velocity, sizeof(c->velocity)) != 0) mask |= REPL_FIELD_VELOCITY;
+        }
+        if (mask == 0) {
+            continue;
+        }
+
+        BitWriter_Write(&w, 1, 1);
+        WriteVar(&w, (uint32_t)(entity - previous - 1));
+        BitWriter_Write(&w, mask, REPL_FIELD_BITS);
+        previous = entity;
+        changed++;
+        if (mask & REPL_FIELD_POSITION) {
+            for (int k = 0; k < 3; k++) WriteDelta(&w, c->position[k] - ref->position[k]);
+        }
+        if (mask & REPL_FIELD_ROTATION) {
+            BitWriter_Write(&w, c->rotation, 32);
+        }
+        if (mask & REPL_FIELD_SCALE) {
+            for (int k = 0; k < 3; k++) WriteDelta(&w, c->scale[k] - ref->scale[k]);
+        }
+        if (mask & REPL_FIELD_VELOCITY) {
+            int hasVelocity = (c->flags & REPL_HAS_VELOCITY) != 0;
+            BitWriter_Write(&w, (uint32_t)hasVelocity, 1);
+            if (hasVelocity) {
+                for (int k = 0; k < 3; k++) WriteDelta(&w, c->velocity[k] - ref->velocity[k]);
+            }
+        }
+    }
+    BitWriter_Write(&w, 0, 1);
+    BitWriter_Flush(&w);
+
+    enc->lastChanged = changed;
+    enc->lastFull = baseline == NULL;
+    enc->lastBytes = w.overflow ? -1 : w.size;
+    return enc->lastBytes;
+}
+
+// --- Receiver ---
+
+int ReplicationReceiver_Init(ReplicationReceiver* rcv) {
+    memset(rcv, 0, sizeof(*rcv));
+    if (AllocHistory(rcv->history) != 0) {
+        ReplicationReceiver_Shutdown(rcv);
+        return -1;
+    }
+    return 0;
+}
+
+void ReplicationReceiver_Shutdown(ReplicationReceiver* rcv) {
+    FreeHistory(rcv->history);
+}
+
+int ReplicationReceiver_Decode(ReplicationReceiver* rcv, const uint8_t* data, int size, uint32_t* seqOut) {
+    BitReader r = { data, size, 0, 0, 0, 0 };
+    uint32_t seq = BitReader_Read(&r, 32);
+    int hasBaseline = (int)BitReader_Read(&r, 1);
+    uint32_t baseSeq = hasBaseline ? BitReader_Read(&r, 32) : 0;
+    if (r.error || seq == 0) {
+        return -1;
+    }
+    int slot = (int)(seq % REPL_HISTORY);
+    const ReplState* baseline = NULL;
+    if (hasBaseline) {
+        int baseSlot = (int)(baseSeq % REPL_HISTORY);
+        if (baseSeq >= seq || seq - baseSeq >= REPL_HISTORY || rcv->historySeq[baseSlot] != baseSeq) {
+            return -1;
+        }
+        baseline = rcv->history[baseSlot];
+    }
+
+    // Start from the baseline (or nothing) and apply the changes.
+    ReplState* frame = rcv->history[slot];
+    rcv->historySeq[slot] = 0;
+    if (baseline) {
+        memcpy(frame, baseline, MAX_ENTITIES * sizeof(ReplState));
+    }
+    else {
+        memset(frame, 0, MAX_ENTITIES * sizeof(ReplState));
+    }
+
+    int entity = -1;
+    while (BitReader_Read(&r, 1) && !r.error) {
+        uint32_t gap = ReadVar(&r);
+        if (gap >= MAX_ENTITIES || entity + 1 + (int)gap >= MAX_ENTITIES) {
+            return -1;
+        }
+        entity += 1 + (int)gap;
+        uint32_t mask = BitReader_Read(&r, REPL_FIELD_BITS);
+        ReplState* s = &frame[entity];
+        if (mask & REPL_FIELD_REMOVED) {
+            *s = kEmptyState;
+            continue;
+        }
+        if (!(s->flags & REPL_PRESENT)) {
+            *s = kEmptyState;
+        }
+        if (mask & REPL_FIELD_POSITION) {
+            for (int k = 0; k < 3; k++) s->position[k] += ReadDelta(&r);
+        }
+        if (mask & REPL_FIELD_ROTATION) {
+            s->rotation = BitReader_Read(&r, 32);
+        }
+        if (mask & REPL_FIELD_SCALE) {
+            for (int k = 0; k < 3; k++) s->scale[k] += ReadDelta(&r);
+        }
+        if (mask & REPL_FIELD_VELOCITY) {
+            if (BitReader_Read(&r, 1)) {
+                if (!(s->flags & REPL_HAS_VELOCITY)) {
+                    memset(s->velocity, 0, sizeof(s->velocity));
+                }
+                for (int k = 0; k < 3; k++) s->velocity[k] += ReadDelta(&r);
+                s->flags |= REPL_HAS_VELOCITY;
+            }
+            else {
+                memset(s->velocity, 0, sizeof(s->velocity));
+                s->flags &= (uint8_t)~REPL_HAS_VELOCITY;
+            }
+        }
+        s->flags |= REPL_PRESENT;
+    }
+    if (r.error) {
+        return -1;
+    }
+
+    rcv->historySeq[slot] = seq;
+    if (seq > rcv->latestSeq) {
+        rcv->latestSeq = seq;
+    }
+    *seqOut = seq;
+    return 0;
+}
+
+const ReplState* ReplicationReceiver_GetState(const ReplicationReceiver* rcv, uint32_t seq, Entity entity) {
+    int slot = (int)(seq % REPL_HISTORY);
+    if (seq == 0 || entity >= MAX_ENTITIES || rcv->historySeq[slot] != seq) {
+        return NULL;
+    }
+    return &rcv->history[slot][entity];
+}
+
+int ReplicationReceiver_GetEntity(const ReplicationReceiver* rcv, Entity entity, Transform* transform, Vec3* velocity) {
+    const ReplState* s = ReplicationReceiver_GetState(rcv, rcv->latestSeq, entity);
+    if (!s || !(s->flags & REPL_PRESENT)) {
+        return 0;
+    }
+    transform->position = Vec3_Make(Dequantize(s->position[0]), Dequantize(s->position[1]), Dequantize(s->position[2]));
+    transform->rotation = UnpackRotation(s->rotation);
+    transform->scale = Vec3_Make(Dequantize(s->scale[0]), Dequantize(s->scale[1]), Dequantize(s->scale[2]));
+    if (velocity) {
+        *velocity = Vec3_Make(Dequantize(s->velocity[0]), Dequantize(s->velocity[1]), Dequantize(s->velocity[2]));
+    }
+    return 1;
+}
+
+// --- Loopback ---
+
+int ReplicationLoopback_Init(ReplicationLoopback* link, int latency, float lossRate, uint32_t seed) {
+    memset(link, 0, sizeof(*link));
+    if (latency < 0 || latency >= REPL_LOOPBACK_SLOTS) {
+        return -1;
+    }
+    link->latency = latency;
+    link->lossRate = lossRate;
+    link->rng = seed ? seed : 1;
+    for (int i = 0; i < REPL_LOOPBACK_SLOTS; i++) {
+        link->packetDue[i] = -1;
+        link->ackDue[i] = -1;
+    }
+    if (ReplicationEncoder_Init(&link->encoder) != 0 || ReplicationReceiver_Init(&link->receiver) != 0) {
+        ReplicationLoopback_Shutdown(link);
+        return -1;
+    }
+    for (int i = 0; i < REPL_LOOPBACK_SLOTS; i++) {
+        link->packets[i] = malloc(REPL_MAX_PACKET_BYTES);
+        if (!link->packets[i]) {
+            ReplicationLoopback_Shutdown(link);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void ReplicationLoopback_Shutdown(ReplicationLoopback* link) {
+    ReplicationEncoder_Shutdown(&link->encoder);
+    ReplicationReceiver_Shutdown(&link->receiver);
+    for (int i = 0; i < REPL_LOOPBACK_SLOTS; i++) {
+        free(link->packets[i]);
+        link->packets[i] = NULL;
+    }
+}
+
+static float LoopbackRandom(ReplicationLoopback* link) {
+    uint32_t x = link->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    link->rng = x;
+    return (float)(x >> 8) / (float)(1u << 24);
+}
+
+int ReplicationLoopback_Tick(ReplicationLoopback* link, const TransformComponentArray* transforms,
+    const RigidBodyComponentArray* rigidBodies)
+{
+    link->frame++;
+
+    // Send. With latency below the slot count a free slot always exists.
+    int slot = 0;
+    while (slot < REPL_LOOPBACK_SLOTS && link->packetDue[slot] != -1) {
+        slot++;
+    }
+    if (slot == REPL_LOOPBACK_SLOTS) {
+        return -1;
+    }
+    int size = ReplicationEncoder_Encode(&link->encoder, transforms, rigidBodies, link->packets[slot], REPL_MAX_PACKET_BYTES);
+    if (size < 0) {
+        return -1;
+    }
+    link->bytesSent += size;
+    link->entitiesSent += link->encoder.lastChanged;
+    link->packetsSent++;
+    link->fullPackets += link->encoder.lastFull;
+    if (LoopbackRandom(link) < link->lossRate) {
+        link->packetsLost++;
+    }
+    else {
+        link->packetSize[slot] = size;
+        link->packetDue[slot] = link->frame + link->latency;
+    }
+
+    // Deliver packets in send order; acks travel back with the same latency.
+    for (;;) {
+        int next = -1;
+        for (int i = 0; i < REPL_LOOPBACK_SLOTS; i++) {
+            if (link->packetDue[i] != -1 && link->packetDue[i] <= link->frame &&
+                (next == -1 || link->packetDue[i] < link->packetDue[next])) {
+                next = i;
+            }
+        }
+        if (next == -1) {
+            break;
+        }
+        uint32_t seq;
+        if (ReplicationReceiver_Decode(&link->receiver, link->packets[next], link->packetSize[next], &seq) == 0) {
+            int ack = 0;
+            while (ack < REPL_LOOPBACK_SLOTS && link->ackDue[ack] != -1) {
+                ack++;
+            }
+            if (ack < REPL_LOOPBACK_SLOTS) {
+                link->acks[ack] = seq;
+                link->ackDue[ack] = link->frame + link->latency;
+            }
+        }
+        else {
+            link->packetsRejected++;
+        }
+        link->packetDue[next] = -1;
+    }
+
+    for (int i = 0; i < REPL_LOOPBACK_SLOTS; i++) {
+        if (link->ackDue[i] != -1 && link->ackDue[i] <= link->frame) {
+            ReplicationEncoder_Ack(&link->encoder, link->acks[i]);
+            link->ackDue[i] = -1;
+        }
+    }
+    return 0;
+}
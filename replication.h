@@ -0,0 +1,121 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <stdint.h>
+#include "entity_manager.h"
+#include "TransformComponent.h"
+#include "rigid_body_component.h"
+
+// Frames of history kept on both ends (power of two). A baseline older than this is
+// treated as lost and the next packet is sent in full.
+#define REPL_HISTORY 16
+// Positions, scales and velocities are sent in units of 1/REPL_QUANTIZE.
+#define REPL_QUANTIZE 256.0f
+// Large enough for a full-state packet of MAX_ENTITIES entities.
+#define REPL_MAX_PACKET_BYTES (MAX_ENTITIES * 64 + 16)
+
+// Quantized state of one entity; what the two ends compare and agree on.
+typedef struct {
+    int32_t position[3];
+    uint32_t rotation;        // Smallest-three: 2-bit index + 3 x 10-bit components.
+    int32_t scale[3];
+    int32_t velocity[3];
+    uint8_t flags;            // REPL_PRESENT, REPL_HAS_VELOCITY.
+} ReplState;
+
+#define REPL_PRESENT 0x1
+#define REPL_HAS_VELOCITY 0x2
+
+// Sender side. Each Encode quantizes the current Transform/RigidBody arrays, diffs
+// them against the newest frame the receiver acknowledged, and bit-packs only the
+// entities and fields that changed.
+typedef struct {
+    ReplState* history[REPL_HISTORY];   // MAX_ENTITIES states per frame.
+    uint32_t historySeq[REPL_HISTORY];
+    uint32_t nextSeq;                   // Sequence of the next packet (starts at 1).
+    uint32_t ackedSeq;                  // 0 until the first ack.
+    int entityLimit;                    // One past the highest entity ever sent.
+
+    // Stats for the last packet.
+    int lastBytes;
+    int lastChanged;                    // Entities written.
+    int lastFull;                       // Sent without a baseline.
+} ReplicationEncoder;
+
+// Receiver side. Rebuilds each frame from its baseline and acknowledges it.
+typedef struct {
+    ReplState* history[REPL_HISTORY];
+    uint32_t historySeq[REPL_HISTORY];  // 0 for an empty slot.
+    uint32_t latestSeq;
+} ReplicationReceiver;
+
+// Returns 0 on success.
+int ReplicationEncoder_Init(ReplicationEncoder* enc);
+void ReplicationEncoder_Shutdown(ReplicationEncoder* enc);
+
+// Encode the current state into out. rigidBodies may be NULL. Returns the packet
+// size in bytes, or -1 if it does not fit.
+int ReplicationEncoder_Encode(ReplicationEncoder* enc, const TransformComponentArray* transforms,
+    const RigidBodyComponentArray* rigidBodies, uint8_t* out, int capacity);
+
+// The receiver has decoded packet seq; later packets may use it as their baseline.
+void ReplicationEncoder_Ack(ReplicationEncoder* enc, uint32_t seq);
+
+// Quantized state the encoder sent for entity in packet seq, or NULL if that frame
+// has left the history.
+const ReplState* ReplicationEncoder_GetSent(const ReplicationEncoder* enc, uint32_t seq, Entity entity);
+
+// Returns 0 on success.
+int ReplicationReceiver_Init(ReplicationReceiver* rcv);
+void ReplicationReceiver_Shutdown(ReplicationReceiver* rcv);
+
+// Decode one packet. On success returns 0 and stores the sequence to acknowledge in
+// *seqOut; returns -1 if the packet is malformed or its baseline is not held.
+int ReplicationReceiver_Decode(ReplicationReceiver* rcv, const uint8_t* data, int size, uint32_t* seqOut);
+
+// Quantized state of entity in frame seq, or NULL if the frame is not held.
+const ReplState* ReplicationReceiver_GetState(const ReplicationReceiver* rcv, uint32_t seq, Entity entity);
+
+// Newest received state of an entity, dequantized. Returns 0 if it is not present.
+// velocity may be NULL.
+int ReplicationReceiver_GetEntity(const ReplicationReceiver* rcv, Entity entity, Transform* transform, Vec3* velocity);
+
+// --- Loopback link for local testing ---
+
+#define REPL_LOOPBACK_SLOTS 8
+
+// Connects an encoder and a receiver in-process, with a fixed latency in frames each
+// way and a deterministic packet loss rate.
+typedef struct {
+    ReplicationEncoder encoder;
+    ReplicationReceiver receiver;
+    int latency;                        // Frames before a packet (or its ack) arrives.
+    float lossRate;                     // Fraction of packets dropped, 0..1.
+    uint32_t rng;
+
+    uint8_t* packets[REPL_LOOPBACK_SLOTS];
+    int packetSize[REPL_LOOPBACK_SLOTS];
+    int packetDue[REPL_LOOPBACK_SLOTS]; // Frame the packet arrives, -1 if empty.
+    uint32_t acks[REPL_LOOPBACK_SLOTS];
+    int ackDue[REPL_LOOPBACK_SLOTS];
+    int frame;
+
+    // Totals.
+    long long bytesSent;
+    long long entitiesSent;
+    int packetsSent;
+    int packetsLost;
+    int packetsRejected;                // Baseline missing at the receiver.
+    int fullPackets;
+} ReplicationLoopback;
+
+// latency must be below REPL_LOOPBACK_SLOTS. Returns 0 on success.
+int ReplicationLoopback_Init(ReplicationLoopback* link, int latency, float lossRate, uint32_t seed);
+void ReplicationLoopback_Shutdown(ReplicationLoopback* link);
+
+// Send this frame's state and deliver whatever packets and acks are due. Returns 0 on
+// success, -1 if encoding failed.
+int ReplicationLoopback_Tick(ReplicationLoopback* link, const TransformComponentArray* transforms,
+    const RigidBodyComponentArray* rigidBodies);
+
+#endif // REPLICATION_H
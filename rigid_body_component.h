@@ -7,6 +7,7 @@
 typedef struct {
     Vec3 velocity;
     Vec3 acceleration;
+    float inverseMass;  // 0 makes the body immovable by contacts.
 } RigidBody;
 
 DEFINE_COMPONENT_ARRAY(RigidBody);
@@ -0,0 +1,72 @@
+#include "sim_pipeline.h"
+#include "logger.h"
+#include <string.h>
+
+static int SimThread(void* data) {
+    SimPipeline* pipeline = (SimPipeline*)data;
+    for (;;) {
+        SDL_WaitSemaphore(pipeline->start);
+        if (SDL_GetAtomicInt(&pipeline->quit)) {
+            break;
+        }
+        Uint64 start = SDL_GetPerformanceCounter();
+        World_Step(pipeline->world, pipeline->dt);
+        World_PublishSnapshot(pipeline->world);
+        pipeline->lastStepMs = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+        SDL_SignalSemaphore(pipeline->done);
+    }
+    return 0;
+}
+
+int SimPipeline_Start(SimPipeline* pipeline, World* world) {
+    memset(pipeline, 0, sizeof(*pipeline));
+    pipeline->world = world;
+    pipeline->start = SDL_CreateSemaphore(0);
+    pipeline->done = SDL_CreateSemaphore(0);
+    if (!pipeline->start || !pipeline->done) {
+        LOG_ERROR("SimPipeline: failed to create semaphores\n");
+        SimPipeline_Stop(pipeline);
+        return -1;
+    }
+    SDL_SetAtomicInt(&pipeline->quit, 0);
+    pipeline->thread = SDL_CreateThread(SimThread, "Simulation", pipeline);
+    if (!pipeline->thread) {
+        LOG_ERROR("SimPipeline: failed to create the simulation thread\n");
+        SimPipeline_Stop(pipeline);
+        return -1;
+    }
+    return 0;
+}
+
+void SimPipeline_Kick(SimPipeline* pipeline, float dt) {
+    SimPipeline_Wait(pipeline);
+    // The semaphore hand-off orders this write before the sim thread reads it.
+    pipeline->dt = dt;
+    pipeline->inFlight = 1;
+    SDL_SignalSemaphore(pipeline->start);
+}
+
+void SimPipeline_Wait(SimPipeline* pipeline) {
+    if (pipeline->inFlight) {
+        SDL_WaitSemaphore(pipeline->done);
+        pipeline->inFlight = 0;
+    }
+}
+
+void SimPipeline_Stop(SimPipeline* pipeline) {
+    SimPipeline_Wait(pipeline);
+    if (pipeline->thread) {
+        SDL_SetAtomicInt(&pipeline->quit, 1);
+        SDL_SignalSemaphore(pipeline->start);
+        SDL_WaitThread(pipeline->thread, NULL);
+        pipeline->thread = NULL;
+    }
+    if (pipeline->start) {
+        SDL_DestroySemaphore(pipeline->start);
+        pipeline->start = NULL;
+    }
+    if (pipeline->done) {
+        SDL_DestroySemaphore(pipeline->done);
+        pipeline->done = NULL;
+    }
+}
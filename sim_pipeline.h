@@ -0,0 +1,39 @@
+#ifndef SIM_PIPELINE_H
+#define SIM_PIPELINE_H
+
+#include <SDL3/SDL.h>
+#include "world.h"
+
+// Runs World_Step on a dedicated thread so the next frame simulates while the
+// current one renders from its snapshot:
+//
+//     SimPipeline_Kick(p, dt);          // frame N+1 starts simulating
+//     World_RenderSnapshot(world, ...); // frame N renders meanwhile
+//     SimPipeline_Wait(p);
+//
+// Between Kick and Wait the main thread must not touch the world except through
+// World_RenderSnapshot.
+typedef struct {
+    World* world;
+    SDL_Thread* thread;
+    SDL_Semaphore* start;     // One signal per requested step.
+    SDL_Semaphore* done;      // One signal per finished step.
+    float dt;
+    int inFlight;             // A step was kicked and not yet waited for.
+    SDL_AtomicInt quit;
+    double lastStepMs;        // Duration of the last step (written by the sim thread).
+} SimPipeline;
+
+// Start the simulation thread. Returns 0 on success.
+int SimPipeline_Start(SimPipeline* pipeline, World* world);
+
+// Begin stepping the world (and publishing its snapshot) on the simulation thread.
+void SimPipeline_Kick(SimPipeline* pipeline, float dt);
+
+// Wait for the step started by the last Kick. Returns immediately if none is running.
+void SimPipeline_Wait(SimPipeline* pipeline);
+
+// Finish any running step and join the thread.
+void SimPipeline_Stop(SimPipeline* pipeline);
+
+#endif // SIM_PIPELINE_H
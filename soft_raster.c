@@ -0,0 +1,235 @@
+#include "soft_raster.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SOFT_RASTER_NEAR 0.1f
+
+int SoftRaster_Init(SoftRaster* raster, int width, int height, JobSystem* jobs) {
+    memset(raster, 0, sizeof(*raster));
+    raster->width = width;
+    raster->height = height;
+    raster->jobs = jobs;
+    raster->tilesX = (width + SOFT_RASTER_TILE_SIZE - 1) / SOFT_RASTER_TILE_SIZE;
+    raster->tilesY = (height + SOFT_RASTER_TILE_SIZE - 1) / SOFT_RASTER_TILE_SIZE;
+
+    raster->color = malloc((size_t)width * height * sizeof(uint32_t));
+    raster->depth = malloc((size_t)width * height * sizeof(float));
+    raster->binStart = malloc(((size_t)raster->tilesX * raster->tilesY + 1) * sizeof(int));
+    if (!raster->color || !raster->depth || !raster->binStart) {
+        LOG_ERROR("SoftRaster_Init: out of memory for %dx%d framebuffer\n", width, height);
+        SoftRaster_Shutdown(raster);
+        return -1;
+    }
+    return 0;
+}
+
+void SoftRaster_Shutdown(SoftRaster* raster) {
+    free(raster->color);
+    free(raster->depth);
+    free(raster->binStart);
+    free(raster->binTriangles);
+    free(raster->triangles);
+    memset(raster, 0, sizeof(*raster));
+}
+
+void SoftRaster_BeginFrame(SoftRaster* raster, SDL_Color clear) {
+    raster->clearColor = ((uint32_t)clear.r << 16) | ((uint32_t)clear.g << 8) | clear.b;
+    raster->triangleCount = 0;
+}
+
+void SoftRaster_SubmitTriangles(SoftRaster* raster, const SoftRasterVertex* vertices,
+    const int* indices, int indexCount, SDL_Color color)
+{
+    uint32_t packed = ((uint32_t)color.r << 16) | ((uint32_t)color.g << 8) | color.b;
+
+    for (int i = 0; i + 2 < indexCount; i += 3) {
+        const SoftRasterVertex* a = &vertices[indices[i]];
+        const SoftRasterVertex* b = &vertices[indices[i + 1]];
+        const SoftRasterVertex* c = &vertices[indices[i + 2]];
+        if (a->depth < SOFT_RASTER_NEAR || b->depth < SOFT_RASTER_NEAR || c->depth < SOFT_RASTER_NEAR) {
+            continue;
+        }
+
+        float minX = fminf(a->x, fminf(b->x, c->x)), maxX = fmaxf(a->x, fmaxf(b->x, c->x));
+        float minY = fminf(a->y, fminf(b->y, c->y)), maxY = fmaxf(a->y, fmaxf(b->y, c->y));
+        if (maxX < 0.0f || maxY < 0.0f || minX >= (float)raster->width || minY >= (float)raster->height) {
+            continue;
+        }
+
+        if (raster->triangleCount == raster->triangleCapacity) {
+            int capacity = raster->triangleCapacity ? raster->triangleCapacity * 2 : 1024;
+            SoftRasterTriangle* grown = realloc(raster->triangles, (size_t)capacity * sizeof(SoftRasterTriangle));
+            if (!grown) {
+                LOG_ERROR("SoftRaster: out of memory for triangles\n");
+                return;
+            }
+            raster->triangles = grown;
+            raster->triangleCapacity = capacity;
+        }
+
+        SoftRasterTriangle* tri = &raster->triangles[raster->triangleCount++];
+        const SoftRasterVertex* v[3] = { a, b, c };
+        for (int k = 0; k < 3; k++) {
+            tri->x[k] = v[k]->x;
+            tri->y[k] = v[k]->y;
+            tri->invDepth[k] = 1.0f / v[k]->depth;
+        }
+        tri->minX = minX < 0.0f ? 0 : (int)minX;
+        tri->minY = minY < 0.0f ? 0 : (int)minY;
+        tri->maxX = maxX >= (float)raster->width ? raster->width - 1 : (int)maxX;
+        tri->maxY = maxY >= (float)raster->height ? raster->height - 1 : (int)maxY;
+        tri->color = packed;
+    }
+}
+
+// Count-then-fill binning so each tile gets its triangles in submission order.
+static int BinTriangles(SoftRaster* raster) {
+    int tileCount = raster->tilesX * raster->tilesY;
+    int* start = raster->binStart;
+    memset(start, 0, ((size_t)tileCount + 1) * sizeof(int));
+
+    for (int t = 0; t < raster->triangleCount; t++) {
+        const SoftRasterTriangle* tri = &raster->triangles[t];
+        for (int ty = tri->minY / SOFT_RASTER_TILE_SIZE; ty <= tri->maxY / SOFT_RASTER_TILE_SIZE; ty++) {
+            for (int tx = tri->minX / SOFT_RASTER_TILE_SIZE; tx <= tri->maxX / SOFT_RASTER_TILE_SIZE; tx++) {
+                start[ty * raster->tilesX + tx + 1]++;
+            }
+        }
+    }
+    for (int i = 0; i < tileCount; i++) {
+        start[i + 1] += start[i];
+    }
+
+    int total = start[tileCount];
+    if (total > raster->binCapacity) {
+        int* grown = realloc(raster->binTriangles, (size_t)total * sizeof(int));
+        if (!grown) {
+            LOG_ERROR("SoftRaster: out of memory for %d bin entries\n", total);
+            return -1;
+        }
+        raster->binTriangles = grown;
+        raster->binCapacity = total;
+    }
+
+    // Fill using start[] as a running cursor, then shift it back into place.
+    for (int t = 0; t < raster->triangleCount; t++) {
+        const SoftRasterTriangle* tri = &raster->triangles[t];
+        for (int ty = tri->minY / SOFT_RASTER_TILE_SIZE; ty <= tri->maxY / SOFT_RASTER_TILE_SIZE; ty++) {
+            for (int tx = tri->minX / SOFT_RASTER_TILE_SIZE; tx <= tri->maxX / SOFT_RASTER_TILE_SIZE; tx++) {
+                raster->binTriangles[start[ty * raster->tilesX + tx]++] = t;
+            }
+        }
+    }
+    for (int i = tileCount; i > 0; i--) {
+        start[i] = start[i - 1];
+    }
+    start[0] = 0;
+    return 0;
+}
+
+static void RasterizeTriangle(SoftRaster* raster, const SoftRasterTriangle* tri,
+    int x0, int y0, int x1, int y1)
+{
+    float ax = tri->x[0], ay = tri->y[0];
+    float bx = tri->x[1], by = tri->y[1];
+    float cx = tri->x[2], cy = tri->y[2];
+    float area = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+    if (fabsf(area) < 1e-6f) {
+        return;
+    }
+    // Both windings are drawn; orient edges so inside is positive.
+    float sign = area > 0.0f ? 1.0f : -1.0f;
+    float invArea = 1.0f / fabsf(area);
+
+    int minX = tri->minX > x0 ? tri->minX : x0;
+    int minY = tri->minY > y0 ? tri->minY : y0;
+    int maxX = tri->maxX < x1 ? tri->maxX : x1;
+    int maxY = tri->maxY < y1 ? tri->maxY : y1;
+
+    // Edge functions evaluated at pixel centers, stepped incrementally.
+    float e0dx = -(cy - by) * sign, e0dy = (cx - bx) * sign;
+    float e1dx = -(ay - cy) * sign, e1dy = (ax - cx) * sign;
+    float e2dx = -(by - ay) * sign, e2dy = (bx - ax) * sign;
+    float px = minX + 0.5f, py = minY + 0.5f;
+    float e0row = ((cx - bx) * (py - by) - (cy - by) * (px - bx)) * sign;
+    float e1row = ((ax - cx) * (py - cy) - (ay - cy) * (px - cx)) * sign;
+    float e2row = ((bx - ax) * (py - ay) - (by - ay) * (px - ax)) * sign;
+
+    for (int y = minY; y <= maxY; y++) {
+        float e0 = e0row, e1 = e1row, e2 = e2row;
+        uint32_t* colorRow = raster->color + (size_t)y * raster->width;
+        float* depthRow = raster->depth + (size_t)y * raster->width;
+        for (int x = minX; x <= maxX; x++) {
+            if (e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f) {
+                float z = (e0 * tri->invDepth[0] + e1 * tri->invDepth[1] + e2 * tri->invDepth[2]) * invArea;
+                if (z > depthRow[x]) {
+                    depthRow[x] = z;
+                    colorRow[x] = tri->color;
+                }
+            }
+            e0 += e0dx; e1 += e1dx; e2 += e2dx;
+        }
+        e0row += e0dy; e1row += e1dy; e2row += e2dy;
+    }
+}
+
+// Clear and rasterize tiles [begin, end).
+static void RasterizeTiles(void* userData, int begin, int end) {
+    SoftRaster* raster = (SoftRaster*)userData;
+    for (int tile = begin; tile < end; tile++) {
+        int x0 = (tile % raster->tilesX) * SOFT_RASTER_TILE_SIZE;
+        int y0 = (tile / raster->tilesX) * SOFT_RASTER_TILE_SIZE;
+        int x1 = x0 + SOFT_RASTER_TILE_SIZE - 1;
+        int y1 = y0 + SOFT_RASTER_TILE_SIZE - 1;
+        if (x1 >= raster->width) x1 = raster->width - 1;
+        if (y1 >= raster->height) y1 = raster->height - 1;
+
+        for (int y = y0; y <= y1; y++) {
+            uint32_t* colorRow = raster->color + (size_t)y * raster->width;
+            float* depthRow = raster->depth + (size_t)y * raster->width;
+            for (int x = x0; x <= x1; x++) {
+                colorRow[x] = raster->clearColor;
+                depthRow[x] = 0.0f;
+            }
+        }
+
+        for (int i = raster->binStart[tile]; i < raster->binStart[tile + 1]; i++) {
+            RasterizeTriangle(raster, &raster->triangles[raster->binTriangles[i]], x0, y0, x1, y1);
+        }
+    }
+}
+
+void SoftRaster_EndFrame(SoftRaster* raster) {
+    if (BinTriangles(raster) != 0) {
+        return;
+    }
+    JobSystem_ParallelFor(raster->jobs, raster->tilesX * raster->tilesY, 1, RasterizeTiles, raster);
+}
+
+int SoftRaster_WritePPM(const SoftRaster* raster, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        LOG_ERROR("SoftRaster: cannot open PPM file for writing\n");
+        return -1;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", raster->width, raster->height);
+    unsigned char* row = malloc((size_t)raster->width * 3);
+    if (!row) {
+        fclose(file);
+        return -1;
+    }
+    for (int y = 0; y < raster->height; y++) {
+        const uint32_t* src = raster->color + (size_t)y * raster->width;
+        for (int x = 0; x < raster->width; x++) {
+            row[x * 3 + 0] = (unsigned char)(src[x] >> 16);
+            row[x * 3 + 1] = (unsigned char)(src[x] >> 8);
+            row[x * 3 + 2] = (unsigned char)src[x];
+        }
+        fwrite(row, 1, (size_t)raster->width * 3, file);
+    }
+    free(row);
+    return fclose(file) == 0 ? 0 : -1;
+}
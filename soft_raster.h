@@ -0,0 +1,65 @@
+#ifndef SOFT_RASTER_H
+#define SOFT_RASTER_H
+
+#include <stdint.h>
+#include <SDL3/SDL.h>
+#include "job_system.h"
+
+// Tile edge in pixels. Triangles are binned into tiles, and tiles are rasterized in
+// parallel, each one clearing and shading only its own part of the framebuffer.
+#define SOFT_RASTER_TILE_SIZE 64
+
+// A projected vertex: screen position in pixels and positive view depth.
+typedef struct {
+    float x;
+    float y;
+    float depth;
+} SoftRasterVertex;
+
+// Triangle after setup, ready for binning.
+typedef struct {
+    float x[3];
+    float y[3];
+    float invDepth[3];   // Interpolated linearly in screen space.
+    int minX, minY, maxX, maxY;
+    uint32_t color;      // 0x00RRGGBB
+} SoftRasterTriangle;
+
+// Headless render target: a color buffer plus a depth buffer held in memory.
+typedef struct SoftRaster {
+    int width;
+    int height;
+    uint32_t* color;     // 0x00RRGGBB per pixel, row-major.
+    float* depth;        // 1/depth per pixel; 0 means empty.
+    uint32_t clearColor;
+    JobSystem* jobs;     // Optional; tiles are rasterized in parallel when set.
+
+    int tilesX;
+    int tilesY;
+    int* binStart;       // Per tile offset into binTriangles (tilesX * tilesY + 1 entries).
+    int* binTriangles;
+    int binCapacity;
+
+    SoftRasterTriangle* triangles;
+    int triangleCount;
+    int triangleCapacity;
+} SoftRaster;
+
+// Allocate the framebuffer. Returns 0 on success.
+int SoftRaster_Init(SoftRaster* raster, int width, int height, JobSystem* jobs);
+void SoftRaster_Shutdown(SoftRaster* raster);
+
+// Start a frame that will be cleared to the given color.
+void SoftRaster_BeginFrame(SoftRaster* raster, SDL_Color clear);
+
+// Queue indexed triangles of one flat color. Triangles touching the near plane are dropped.
+void SoftRaster_SubmitTriangles(SoftRaster* raster, const SoftRasterVertex* vertices,
+    const int* indices, int indexCount, SDL_Color color);
+
+// Bin the queued triangles and rasterize every tile.
+void SoftRaster_EndFrame(SoftRaster* raster);
+
+// Write the color buffer as a binary PPM. Returns 0 on success.
+int SoftRaster_WritePPM(const SoftRaster* raster, const char* path);
+
+#endif // SOFT_RASTER_H
@@ -0,0 +1,192 @@
+#include "spatial_sort.h"
+#include <string.h>
+
+int SpatialSort_Init(SpatialSort* sort, Arena* arena, TransformComponentArray* transforms, int swapBudget) {
+    memset(sort, 0, sizeof(*sort));
+    sort->transforms = transforms;
+    sort->swapBudget = swapBudget > 0 ? swapBudget : 1;
+    sort->replanInterval = 60;
+    sort->plan = ARENA_NEW_ARRAY(arena, Entity, MAX_ENTITIES);
+    sort->keys[0] = ARENA_NEW_ARRAY(arena, uint32_t, MAX_ENTITIES);
+    sort->keys[1] = ARENA_NEW_ARRAY(arena, uint32_t, MAX_ENTITIES);
+    sort->sortScratch = ARENA_NEW_ARRAY(arena, Entity, MAX_ENTITIES);
+    sort->member = ARENA_NEW_ARRAY(arena, uint8_t, MAX_ENTITIES);
+    if (!sort->plan || !sort->keys[0] || !sort->keys[1] || !sort->sortScratch || !sort->member) {
+        return -1;
+    }
+    memset(sort->member, 0, MAX_ENTITIES);
+    return 0;
+}
+
+void SpatialSort_AddArray(SpatialSort* sort, IComponentArray* array) {
+    assert(sort->arrayCount < SPATIAL_SORT_MAX_ARRAYS && "Too many arrays in the sort group.");
+    sort->arrays[sort->arrayCount++] = array;
+}
+
+void SpatialSort_AddSystem(SpatialSort* sort, ECS_System* system) {
+    assert(sort->systemCount < SPATIAL_SORT_MAX_SYSTEMS && "Too many systems in the sort group.");
+    sort->systems[sort->systemCount++] = system;
+}
+
+// Spread the low 10 bits of v so there are two zero bits between each.
+static inline uint32_t SpreadBits(uint32_t v) {
+    v &= 0x3FF;
+    v = (v | (v << 16)) & 0x030000FF;
+    v = (v | (v << 8)) & 0x0300F00F;
+    v = (v | (v << 4)) & 0x030C30C3;
+    v = (v | (v << 2)) & 0x09249249;
+    return v;
+}
+
+static inline uint32_t Quantize(float value, float min, float max) {
+    float t = max > min ? (value - min) / (max - min) : 0.0f;
+    if (!(t > 0.0f)) return 0;   // Also catches NaN.
+    if (t >= 1.0f) return 1023;
+    return (uint32_t)(t * 1023.0f);
+}
+
+uint32_t SpatialSort_MortonCode(Vec3 position, Vec3 min, Vec3 max) {
+    return SpreadBits(Quantize(position.x, min.x, max.x)) |
+        (SpreadBits(Quantize(position.y, min.y, max.y)) << 1) |
+        (SpreadBits(Quantize(position.z, min.z, max.z)) << 2);
+}
+
+// Order every Transform entity by Morton code: bounds from the current positions,
+// then an LSD radix sort of the 30-bit keys (three 10-bit digits, stable).
+static void MakePlan(SpatialSort* sort) {
+    TransformComponentArray* transforms = sort->transforms;
+    int n = (int)transforms->size;
+    sort->planCount = n;
+    sort->planSize = transforms->size;
+    sort->stage = 0;
+    sort->planCursor = 0;
+    sort->slotCursor = 0;
+    sort->applied = 0;
+    sort->planFrame = sort->frame;
+    sort->plans++;
+    if (n == 0) {
+        return;
+    }
+
+    Vec3 min = transforms->components[0].position;
+    Vec3 max = min;
+    for (int i = 1; i < n; i++) {
+        Vec3 p = transforms->components[i].position;
+        if (p.x < min.x) min.x = p.x;
+        if (p.y < min.y) min.y = p.y;
+        if (p.z < min.z) min.z = p.z;
+        if (p.x > max.x) max.x = p.x;
+        if (p.y > max.y) max.y = p.y;
+        if (p.z > max.z) max.z = p.z;
+    }
+
+    uint32_t* keys[2] = { sort->keys[0], sort->keys[1] };
+    Entity* values[2] = { sort->plan, sort->sortScratch };
+    for (int i = 0; i < n; i++) {
+        keys[0][i] = SpatialSort_MortonCode(transforms->components[i].position, min, max);
+        values[0][i] = transforms->indexToEntityMap[i];
+    }
+    int src = 0;
+    for (int shift = 0; shift < 30; shift += 10) {
+        int histogram[1024] = { 0 };
+        for (int i = 0; i < n; i++) {
+            histogram[(keys[src][i] >> shift) & 0x3FF]++;
+        }
+        int offset = 0;
+        for (int d = 0; d < 1024; d++) {
+            int c = histogram[d];
+            histogram[d] = offset;
+            offset += c;
+        }
+        int dst = src ^ 1;
+        for (int i = 0; i < n; i++) {
+            int pos = histogram[(keys[src][i] >> shift) & 0x3FF]++;
+            keys[dst][pos] = keys[src][i];
+            values[dst][pos] = values[src][i];
+        }
+        src = dst;
+    }
+    if (src != 0) {
+        memcpy(sort->plan, sort->sortScratch, sizeof(Entity) * (size_t)n);
+    }
+}
+
+// Put each system's entities in Transform dense order; entities without a Transform
+// keep their relative order at the end.
+static void ReorderSystems(SpatialSort* sort) {
+    TransformComponentArray* transforms = sort->transforms;
+    for (int s = 0; s < sort->systemCount; s++) {
+        ECS_System* system = sort->systems[s];
+        for (int i = 0; i < system->count; i++) {
+            sort->member[system->entities[i]] = 1;
+        }
+        int count = 0;
+        for (size_t i = 0; i < transforms->size; i++) {
+            Entity entity = transforms->indexToEntityMap[i];
+            if (sort->member[entity]) {
+                sort->sortScratch[count++] = entity;
+                sort->member[entity] = 0;
+            }
+        }
+        for (int i = 0; i < system->count; i++) {
+            Entity entity = system->entities[i];
+            if (sort->member[entity]) {
+                sort->sortScratch[count++] = entity;
+                sort->member[entity] = 0;
+            }
+        }
+        if (memcmp(system->entities, sort->sortScratch, sizeof(Entity) * (size_t)count) != 0) {
+            memcpy(system->entities, sort->sortScratch, sizeof(Entity) * (size_t)count);
+            for (int i = 0; i < count; i++) {
+                system->slot[system->entities[i]] = i;
+            }
+            system->version++;
+        }
+    }
+}
+
+int SpatialSort_Step(SpatialSort* sort) {
+    sort->frame++;
+    if (sort->planSize != sort->transforms->size ||
+        (sort->applied && sort->frame - sort->planFrame >= (uint64_t)sort->replanInterval)) {
+        MakePlan(sort);
+    }
+    if (sort->applied) {
+        return 0;
+    }
+
+    int budget = sort->swapBudget;
+    int swaps = 0;
+    while (sort->stage <= sort->arrayCount) {
+        IComponentArray* array = sort->stage == 0 ? &sort->transforms->base : sort->arrays[sort->stage - 1];
+        size_t size = array->GetSize(array);
+        while (sort->planCursor < sort->planCount && (size_t)sort->slotCursor < size) {
+            // Entities removed since the plan, or absent from this array, are skipped.
+            // A removal can also move one into an already placed slot; leave it there.
+            int index = array->IndexOf(array, sort->plan[sort->planCursor]);
+            if (index < sort->slotCursor) {
+                sort->planCursor++;
+                continue;
+            }
+            if (index != sort->slotCursor) {
+                if (swaps == budget) {
+                    sort->swaps += (uint64_t)swaps;
+                    return swaps;
+                }
+                array->Swap(array, (size_t)sort->slotCursor, (size_t)index);
+                swaps++;
+            }
+            sort->planCursor++;
+            sort->slotCursor++;
+        }
+        sort->stage++;
+        sort->planCursor = 0;
+        sort->slotCursor = 0;
+    }
+
+    ReorderSystems(sort);
+    sort->applied = 1;
+    sort->passes++;
+    sort->swaps += (uint64_t)swaps;
+    return swaps;
+}
@@ -0,0 +1,67 @@
+#ifndef SPATIAL_SORT_H
+#define SPATIAL_SORT_H
+
+#include <stdint.h>
+#include "ComponentArray.h"
+#include "TransformComponent.h"
+#include "System.h"
+#include "arena.h"
+
+#define SPATIAL_SORT_MAX_ARRAYS 8
+#define SPATIAL_SORT_MAX_SYSTEMS 8
+
+// Incrementally reorders a group of dense component arrays by the Morton code of
+// Transform.position, so entities that are close in space are close in memory.
+//
+// A plan (every Transform entity in Morton order) is made in one O(n) pass, then
+// applied a bounded number of swaps per frame: the Transform array first, then each
+// other array of the group, which follows the same entity order. Once a plan is fully
+// applied, the registered systems' entity lists are put in the same order so their
+// loops walk memory forwards. A new plan is made every replanInterval frames, or
+// early if the Transform array changed size.
+typedef struct {
+    TransformComponentArray* transforms;
+    IComponentArray* arrays[SPATIAL_SORT_MAX_ARRAYS];    // Follow the Transform order.
+    int arrayCount;
+    ECS_System* systems[SPATIAL_SORT_MAX_SYSTEMS];      // Reordered after each pass.
+    int systemCount;
+
+    int swapBudget;           // Swaps per SpatialSort_Step, over all arrays.
+    int replanInterval;       // Frames between plans once one has been applied.
+
+    // Plan and scratch, MAX_ENTITIES entries each.
+    Entity* plan;             // Entities in Morton order.
+    uint32_t* keys[2];
+    Entity* sortScratch;
+    uint8_t* member;
+    int planCount;
+    size_t planSize;          // Transform array size the plan was made for.
+    int stage;                // 0: Transform array, 1..arrayCount: arrays[stage - 1].
+    int planCursor;           // Next plan entry to place.
+    int slotCursor;           // Dense index it goes to.
+    int applied;              // The plan is fully applied.
+    uint64_t frame;
+    uint64_t planFrame;
+
+    // Stats.
+    uint64_t swaps;
+    uint32_t plans;
+    uint32_t passes;          // Plans applied completely.
+} SpatialSort;
+
+// Set up a sorter over a Transform array. Scratch comes from the arena. Returns 0 on
+// success.
+int SpatialSort_Init(SpatialSort* sort, Arena* arena, TransformComponentArray* transforms, int swapBudget);
+
+// Add another array of the group, or a system whose entity list should follow.
+void SpatialSort_AddArray(SpatialSort* sort, IComponentArray* array);
+void SpatialSort_AddSystem(SpatialSort* sort, ECS_System* system);
+
+// Do one frame's share of the work. Call between steps, never while a system is
+// iterating the arrays. Returns the number of swaps made.
+int SpatialSort_Step(SpatialSort* sort);
+
+// Morton code of a position quantized to 10 bits per axis inside [min, max].
+uint32_t SpatialSort_MortonCode(Vec3 position, Vec3 min, Vec3 max);
+
+#endif // SPATIAL_SORT_H
@@ -34,8 +34,9 @@ static inline void SystemManager_EntitySignatureChanged(SystemManager* mgr, Enti
     for (int i = 0; i < mgr->count; i++) {
         ECS_System* sys = mgr->systems[i];
 
-        // Check if entity has all the required components
-        if ((entitySignature & sys->requiredSignature) == sys->requiredSignature) {
+        // Check if entity has all the required components and none of the excluded ones
+        if ((entitySignature & sys->requiredSignature) == sys->requiredSignature &&
+            (entitySignature & sys->excludedSignature) == 0) {
             ECS_System_AddEntity(sys, entity); // Fixed function call
         }
         else {
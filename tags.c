@@ -0,0 +1,43 @@
+#include "tags.h"
+#include <string.h>
+#include <assert.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+void TagBitset_Init(TagBitset* set) {
+    memset(set->words, 0, sizeof(set->words));
+    set->count = 0;
+}
+
+static inline int LowestBit(uint64_t word) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return (int)index;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+int TagQuery_Collect(const TagQuery* query, Entity* out, int maxCount) {
+    assert(query->allCount > 0 && "A tag query needs at least one required tag.");
+    int found = 0;
+    for (int w = 0; w < TAG_BITSET_WORDS; w++) {
+        uint64_t word = query->all[0]->words[w];
+        for (int i = 1; i < query->allCount && word; i++) {
+            word &= query->all[i]->words[w];
+        }
+        for (int i = 0; i < query->noneCount && word; i++) {
+            word &= ~query->none[i]->words[w];
+        }
+        while (word) {
+            if (found < maxCount) {
+                out[found] = (Entity)(w * 64 + LowestBit(word));
+            }
+            found++;
+            word &= word - 1;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,54 @@
+#ifndef TAGS_H
+#define TAGS_H
+
+#include <stdint.h>
+#include "entity_manager.h"
+#include "ComponentTypes.h"
+
+#define TAG_BITSET_WORDS ((MAX_ENTITIES + 63) / 64)
+
+// Dense membership bitset for one tag: MAX_ENTITIES bits, about 1.2 KB, instead of
+// the three MAX_ENTITIES arrays a component array needs.
+typedef struct {
+    uint64_t words[TAG_BITSET_WORDS];
+    int count;                // Entities with the bit set.
+} TagBitset;
+
+void TagBitset_Init(TagBitset* set);
+
+static inline int TagBitset_Test(const TagBitset* set, Entity entity) {
+    return (int)((set->words[entity >> 6] >> (entity & 63)) & 1u);
+}
+
+static inline void TagBitset_Set(TagBitset* set, Entity entity) {
+    uint64_t bit = (uint64_t)1 << (entity & 63);
+    if (!(set->words[entity >> 6] & bit)) {
+        set->words[entity >> 6] |= bit;
+        set->count++;
+    }
+}
+
+static inline void TagBitset_Clear(TagBitset* set, Entity entity) {
+    uint64_t bit = (uint64_t)1 << (entity & 63);
+    if (set->words[entity >> 6] & bit) {
+        set->words[entity >> 6] &= ~bit;
+        set->count--;
+    }
+}
+
+#define TAG_QUERY_MAX 4
+
+// Entities that carry every tag in `all` and none in `none`, evaluated 64 entities
+// at a time. At least one `all` set is required.
+typedef struct {
+    const TagBitset* all[TAG_QUERY_MAX];
+    int allCount;
+    const TagBitset* none[TAG_QUERY_MAX];
+    int noneCount;
+} TagQuery;
+
+// Write up to maxCount matching entities to out in ascending order. Returns the
+// number of matches (which may exceed maxCount).
+int TagQuery_Collect(const TagQuery* query, Entity* out, int maxCount);
+
+#endif // TAGS_H
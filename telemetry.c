@@ -0,0 +1,130 @@
+#include "telemetry.h"
+#include "logger.h"
+#include <string.h>
+
+void Telemetry_Collect(const Coordinator* coordinator, EcsStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+
+    const EntityManager* entities = coordinator->entityManager;
+    stats->livingEntities = entities->LivingEntityCount;
+    stats->peakLivingEntities = entities->PeakLivingEntityCount;
+    stats->entityCapacity = MAX_ENTITIES;
+    stats->created = entities->CreatedCount;
+    stats->destroyed = entities->DestroyedCount;
+
+    const ComponentManager* components = coordinator->componentManager;
+    for (int type = 0; type < MAX_COMPONENT_TYPES; type++) {
+        const IComponentArray* array = components->componentArrays[type];
+        if (!array) {
+            continue;
+        }
+        ComponentArrayStats* out = &stats->arrays[stats->arrayCount++];
+        out->name = array->name;
+        out->type = type;
+        out->size = array->GetSize ? array->GetSize(array) : 0;
+        out->highWater = array->highWater;
+        out->capacity = array->capacity;
+        out->bytesReserved = array->bytesReserved;
+        // The sparse map is written in full by Init; the dense side only up to size.
+        out->bytesUsed = out->size * (array->componentSize + sizeof(uint32_t)) + array->capacity * sizeof(int);
+        stats->arrayBytesReserved += out->bytesReserved;
+        stats->arrayBytesUsed += out->bytesUsed;
+    }
+
+    const SystemManager* systems = coordinator->systemManager;
+    for (int i = 0; i < systems->count; i++) {
+        const ECS_System* system = systems->systems[i];
+        SystemStats* out = &stats->systems[stats->systemCount++];
+        out->name = system->name ? system->name : "?";
+        out->count = system->count;
+        out->highWater = system->highWater;
+        out->capacity = MAX_SYSTEM_ENTITIES;
+    }
+
+    if (coordinator->arena) {
+        stats->arenaUsed = coordinator->arena->used;
+        stats->arenaHighWater = coordinator->arena->highWater;
+        stats->arenaSize = coordinator->arena->size;
+    }
+}
+
+void Telemetry_Init(Telemetry* telemetry, const Coordinator* coordinator, int interval, TelemetrySink sink, void* user) {
+    memset(telemetry, 0, sizeof(*telemetry));
+    telemetry->coordinator = coordinator;
+    telemetry->sink = sink;
+    telemetry->user = user;
+    telemetry->interval = interval;
+    telemetry->reportedCreated = coordinator->entityManager->CreatedCount;
+    telemetry->reportedDestroyed = coordinator->entityManager->DestroyedCount;
+}
+
+void Telemetry_Frame(Telemetry* telemetry) {
+    telemetry->frame++;
+    telemetry->framesSinceReport++;
+    if (!telemetry->sink || telemetry->interval < 1 || telemetry->framesSinceReport < telemetry->interval) {
+        return;
+    }
+
+    EcsStats* stats = &telemetry->latest;
+    Telemetry_Collect(telemetry->coordinator, stats);
+    uint64_t created = stats->created;
+    uint64_t destroyed = stats->destroyed;
+    stats->created = created - telemetry->reportedCreated;
+    stats->destroyed = destroyed - telemetry->reportedDestroyed;
+    stats->frame = telemetry->frame;
+    stats->framesCovered = telemetry->framesSinceReport;
+    telemetry->reportedCreated = created;
+    telemetry->reportedDestroyed = destroyed;
+    telemetry->framesSinceReport = 0;
+
+    telemetry->sink(stats, telemetry->user);
+}
+
+static double Percent(size_t part, size_t whole) {
+    return whole ? 100.0 * (double)part / (double)whole : 0.0;
+}
+
+void Telemetry_LogSink(const EcsStats* stats, void* user) {
+    (void)user;
+    // The logger takes at most LOG_MAX_ARGS arguments per message.
+    LOG_INFO("ECS stats @%llu: %u/%u entities (peak %u), +%llu/-%llu\n",
+        (unsigned long long)stats->frame, stats->livingEntities, stats->entityCapacity, stats->peakLivingEntities,
+        (unsigned long long)stats->created, (unsigned long long)stats->destroyed);
+    LOG_INFO("  over %d frames; arrays %zu of %zu KB used; arena %zu of %zu KB (peak %zu KB)\n",
+        stats->framesCovered, stats->arrayBytesUsed / 1024, stats->arrayBytesReserved / 1024,
+        stats->arenaUsed / 1024, stats->arenaSize / 1024, stats->arenaHighWater / 1024);
+    for (int i = 0; i < stats->arrayCount; i++) {
+        const ComponentArrayStats* a = &stats->arrays[i];
+        LOG_INFO("  array %-10s %5zu (%.1f%% full, peak %zu), %zu of %zu KB\n",
+            a->name, a->size, Percent(a->size, a->capacity), a->highWater,
+            a->bytesUsed / 1024, a->bytesReserved / 1024);
+    }
+    for (int i = 0; i < stats->systemCount; i++) {
+        const SystemStats* s = &stats->systems[i];
+        LOG_INFO("  system %-9s %5d/%d (%.1f%%, peak %d)\n",
+            s->name, s->count, s->capacity, Percent((size_t)s->count, (size_t)s->capacity), s->highWater);
+    }
+}
+
+void Telemetry_WriteCsvHeader(FILE* file) {
+    fprintf(file, "frame,kind,name,count,peak,capacity,bytes_used,bytes_reserved,created,destroyed\n");
+}
+
+void Telemetry_CsvSink(const EcsStats* stats, void* user) {
+    FILE* file = (FILE*)user;
+    unsigned long long frame = (unsigned long long)stats->frame;
+    fprintf(file, "%llu,entities,,%u,%u,%u,%zu,%zu,%llu,%llu\n",
+        frame, stats->livingEntities, stats->peakLivingEntities, stats->entityCapacity,
+        stats->arenaUsed, stats->arenaSize,
+        (unsigned long long)stats->created, (unsigned long long)stats->destroyed);
+    for (int i = 0; i < stats->arrayCount; i++) {
+        const ComponentArrayStats* a = &stats->arrays[i];
+        fprintf(file, "%llu,array,%s,%zu,%zu,%zu,%zu,%zu,,\n",
+            frame, a->name, a->size, a->highWater, a->capacity, a->bytesUsed, a->bytesReserved);
+    }
+    for (int i = 0; i < stats->systemCount; i++) {
+        const SystemStats* s = &stats->systems[i];
+        fprintf(file, "%llu,system,%s,%d,%d,%d,,,,\n", frame, s->name, s->count, s->highWater, s->capacity);
+    }
+    fflush(file);
+}
@@ -0,0 +1,83 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "coordinator.h"
+
+// Occupancy of one registered component array.
+typedef struct {
+    const char* name;
+    int type;                 // ComponentType it is registered under.
+    size_t size;              // Components stored now.
+    size_t highWater;         // Most components ever stored.
+    size_t capacity;
+    size_t bytesReserved;     // Whole array: dense data plus both maps.
+    size_t bytesUsed;         // Live dense data plus the entity-to-index map.
+} ComponentArrayStats;
+
+// Membership of one registered system.
+typedef struct {
+    const char* name;
+    int count;
+    int highWater;
+    int capacity;
+} SystemStats;
+
+// One report: storage, systems and entity churn since the previous report.
+typedef struct {
+    uint64_t frame;           // Frames seen by the collector so far.
+    int framesCovered;        // Frames since the previous report.
+
+    uint32_t livingEntities;
+    uint32_t peakLivingEntities;
+    uint32_t entityCapacity;
+    uint64_t created;         // Entities created since the previous report.
+    uint64_t destroyed;       // Entities destroyed since the previous report.
+
+    ComponentArrayStats arrays[MAX_COMPONENT_TYPES];
+    int arrayCount;
+    size_t arrayBytesReserved;
+    size_t arrayBytesUsed;
+
+    SystemStats systems[MAX_SYSTEMS];
+    int systemCount;
+
+    size_t arenaUsed;         // Coordinator arena, 0 if there is none.
+    size_t arenaHighWater;
+    size_t arenaSize;
+} EcsStats;
+
+// Receives a report every `interval` frames.
+typedef void (*TelemetrySink)(const EcsStats* stats, void* user);
+
+typedef struct {
+    const Coordinator* coordinator;
+    TelemetrySink sink;       // NULL: collect only on request.
+    void* user;
+    int interval;
+    int framesSinceReport;
+    uint64_t frame;
+    uint64_t reportedCreated; // Entity counters at the previous report.
+    uint64_t reportedDestroyed;
+    EcsStats latest;          // Last report handed to the sink.
+} Telemetry;
+
+// Fill in stats from the coordinator's managers. Churn covers everything since Init.
+void Telemetry_Collect(const Coordinator* coordinator, EcsStats* stats);
+
+// Report to sink every interval frames (interval < 1 disables reporting).
+void Telemetry_Init(Telemetry* telemetry, const Coordinator* coordinator, int interval, TelemetrySink sink, void* user);
+
+// Call once per frame, after the frame's structural changes. Cheap except on report
+// frames. Runs on the thread that steps the world.
+void Telemetry_Frame(Telemetry* telemetry);
+
+// Built-in sinks: a summary through the logger (user is ignored), or CSV rows, one
+// per array and system, to a FILE* passed as user.
+void Telemetry_LogSink(const EcsStats* stats, void* user);
+void Telemetry_CsvSink(const EcsStats* stats, void* user);
+void Telemetry_WriteCsvHeader(FILE* file);
+
+#endif // TELEMETRY_H
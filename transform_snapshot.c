@@ -0,0 +1,46 @@
+#include "transform_snapshot.h"
+
+// Set in `latest` when the buffer it names has not been acquired yet.
+#define SNAPSHOT_FRESH 0x4
+#define SNAPSHOT_INDEX_MASK 0x3
+
+int SnapshotBuffer_Init(SnapshotBuffer* sb, Arena* arena, int capacity) {
+    for (int i = 0; i < SNAPSHOT_BUFFER_COUNT; i++) {
+        TransformSnapshot* snapshot = &sb->buffers[i];
+        snapshot->transforms = ARENA_NEW_ARRAY(arena, Transform, capacity);
+        snapshot->colors = ARENA_NEW_ARRAY(arena, SDL_Color, capacity);
+        if (!snapshot->transforms || !snapshot->colors) {
+            return -1;
+        }
+        snapshot->count = 0;
+        snapshot->frame = 0;
+    }
+    sb->capacity = capacity;
+    sb->writeIndex = 0;
+    sb->readIndex = 1;
+    SDL_SetAtomicInt(&sb->latest, 2);
+    return 0;
+}
+
+TransformSnapshot* SnapshotBuffer_BeginWrite(SnapshotBuffer* sb) {
+    return &sb->buffers[sb->writeIndex];
+}
+
+void SnapshotBuffer_Publish(SnapshotBuffer* sb) {
+    // Make the buffer contents visible before the index that names it.
+    SDL_MemoryBarrierRelease();
+    int previous = SDL_SetAtomicInt(&sb->latest, sb->writeIndex | SNAPSHOT_FRESH);
+    // Whatever was in `latest` (read or not) is free to overwrite now.
+    sb->writeIndex = previous & SNAPSHOT_INDEX_MASK;
+}
+
+const TransformSnapshot* SnapshotBuffer_Acquire(SnapshotBuffer* sb) {
+    if (SDL_GetAtomicInt(&sb->latest) & SNAPSHOT_FRESH) {
+        int latest = SDL_SetAtomicInt(&sb->latest, sb->readIndex);
+        SDL_MemoryBarrierAcquire();
+        sb->readIndex = latest & SNAPSHOT_INDEX_MASK;
+    }
+    // Buffers that were never published still have frame 0.
+    const TransformSnapshot* snapshot = &sb->buffers[sb->readIndex];
+    return snapshot->frame > 0 ? snapshot : NULL;
+}
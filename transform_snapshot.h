@@ -0,0 +1,43 @@
+#ifndef TRANSFORM_SNAPSHOT_H
+#define TRANSFORM_SNAPSHOT_H
+
+#include <SDL3/SDL.h>
+#include <stdint.h>
+#include "components.h"
+#include "arena.h"
+
+#define SNAPSHOT_BUFFER_COUNT 3
+
+// An immutable copy of what the renderer needs from one simulation frame.
+typedef struct {
+    Transform* transforms;
+    SDL_Color* colors;
+    int count;
+    uint64_t frame;          // Simulation frame the snapshot was taken after (0: never written).
+} TransformSnapshot;
+
+// Triple buffer between one producer (the simulation) and one consumer (the
+// renderer). Each side owns one buffer; the third is exchanged through `latest`
+// with a single atomic swap, so neither side ever waits for the other.
+typedef struct {
+    TransformSnapshot buffers[SNAPSHOT_BUFFER_COUNT];
+    int capacity;
+    SDL_AtomicInt latest;    // Buffer index, plus SNAPSHOT_FRESH when unread.
+    int writeIndex;          // Owned by the producer.
+    int readIndex;           // Owned by the consumer.
+} SnapshotBuffer;
+
+// Carve the three buffers out of an arena. Returns 0 on success.
+int SnapshotBuffer_Init(SnapshotBuffer* sb, Arena* arena, int capacity);
+
+// Producer: the buffer to fill next. Stays valid until SnapshotBuffer_Publish.
+TransformSnapshot* SnapshotBuffer_BeginWrite(SnapshotBuffer* sb);
+
+// Producer: hand the filled buffer to the consumer.
+void SnapshotBuffer_Publish(SnapshotBuffer* sb);
+
+// Consumer: the newest published snapshot. Stays valid (and unchanged) until the
+// next call. Returns NULL if nothing has been published yet.
+const TransformSnapshot* SnapshotBuffer_Acquire(SnapshotBuffer* sb);
+
+#endif // TRANSFORM_SNAPSHOT_H
@@ -0,0 +1,91 @@
+#include "update_lod.h"
+#include "math3d.h"
+#include <string.h>
+
+void UpdateLod_Init(UpdateLod* lod, TransformComponentArray* transforms) {
+    memset(lod, 0, sizeof(*lod));
+    lod->transforms = transforms;
+    lod->focus = Vec3_Make(0.0f, 0.0f, 0.0f);
+    lod->levelCount = UPDATE_LOD_MAX_LEVELS;
+    lod->distances[0] = 80.0f;
+    lod->distances[1] = 120.0f;
+    lod->distances[2] = 160.0f;
+    lod->epoch = 1;
+}
+
+int UpdateLod_LevelFor(const UpdateLod* lod, Vec3 position) {
+    Vec3 d = Vec3_Sub(position, lod->focus);
+    float distanceSq = Vec3_Dot(d, d);
+    int level = 0;
+    while (level + 1 < lod->levelCount && distanceSq > lod->distances[level] * lod->distances[level]) {
+        level++;
+    }
+    return level;
+}
+
+static inline int BucketOf(const UpdateLod* lod, Entity entity) {
+    int interval = 1 << lod->level[entity];
+    return interval - 1 + (int)(entity & (Entity)(interval - 1));
+}
+
+// Regroup the entities by bucket (counting sort). Entities not in the previous build
+// start at the level their position gives and as if they last ticked one frame ago.
+static void Rebuild(UpdateLod* lod, const Entity* entities, int count, uint32_t version, float dt) {
+    uint32_t previous = lod->epoch++;
+    int counts[UPDATE_LOD_BUCKETS] = { 0 };
+    for (int i = 0; i < count; i++) {
+        Entity entity = entities[i];
+        if (lod->memberEpoch[entity] != previous) {
+            const Transform* transform = TransformComponentArray_GetData(lod->transforms, entity);
+            lod->level[entity] = (uint8_t)UpdateLod_LevelFor(lod, transform->position);
+            lod->lastTick[entity] = lod->time - dt;
+        }
+        lod->memberEpoch[entity] = lod->epoch;
+        counts[BucketOf(lod, entity)]++;
+    }
+    lod->bucketStart[0] = 0;
+    for (int b = 0; b < UPDATE_LOD_BUCKETS; b++) {
+        lod->bucketStart[b + 1] = lod->bucketStart[b] + counts[b];
+        counts[b] = lod->bucketStart[b];
+    }
+    for (int i = 0; i < count; i++) {
+        Entity entity = entities[i];
+        lod->order[counts[BucketOf(lod, entity)]++] = entity;
+    }
+    lod->builtVersion = version;
+    lod->builtFrame = lod->frame;
+    lod->levelChanges = 0;
+    lod->rebuilds++;
+}
+
+void UpdateLod_BeginFrame(UpdateLod* lod, const Entity* entities, int count, uint32_t version, float dt) {
+    lod->frame++;
+    lod->time += dt;
+    if (lod->builtVersion != version || lod->rebuilds == 0 ||
+        (lod->levelChanges > 0 && lod->frame - lod->builtFrame >= UPDATE_LOD_REBUILD_FRAMES)) {
+        Rebuild(lod, entities, count, version, dt);
+    }
+
+    lod->dueCount = 0;
+    for (int level = 0; level < lod->levelCount; level++) {
+        int interval = 1 << level;
+        int bucket = interval - 1 + (int)(lod->frame & (uint64_t)(interval - 1));
+        for (int i = lod->bucketStart[bucket]; i < lod->bucketStart[bucket + 1]; i++) {
+            Entity entity = lod->order[i];
+            lod->dt[entity] = (float)(lod->time - lod->lastTick[entity]);
+            lod->lastTick[entity] = lod->time;
+            lod->dueFrame[entity] = lod->frame;
+            lod->due[lod->dueCount++] = entity;
+
+            // Entities keep their bucket until the next rebuild; the dt is right either way.
+            const Transform* transform = TransformComponentArray_GetData(lod->transforms, entity);
+            int newLevel = UpdateLod_LevelFor(lod, transform->position);
+            if (newLevel != lod->level[entity]) {
+                lod->level[entity] = (uint8_t)newLevel;
+                lod->levelChanges++;
+            }
+        }
+    }
+    lod->ticks += (uint64_t)lod->dueCount;
+    lod->memberFrames += (uint64_t)count;
+}
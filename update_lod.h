@@ -0,0 +1,77 @@
+#ifndef UPDATE_LOD_H
+#define UPDATE_LOD_H
+
+#include <stdint.h>
+#include "System.h"
+#include "TransformComponent.h"
+
+// Update-rate LOD: entities far from a focus point (the camera) are ticked less
+// often. Level L ticks every 2^L frames, so up to UPDATE_LOD_MAX_LEVELS levels give
+// intervals of 1, 2, 4 and 8 frames.
+//
+// The entities given each frame (for physics, the awake bodies) are bucketed by
+// (level, entity & (interval - 1)); each frame only the bucket due at every level is
+// visited, so the per-frame cost falls with the share of distant entities and is
+// nothing for entities left out of the list. A due entity gets the time since its
+// own last tick as its dt; one that rejoins the list starts afresh. Its level is
+// re-evaluated from its position when it ticks, and the buckets are rebuilt when the
+// list changes or, lazily, after level changes.
+#define UPDATE_LOD_MAX_LEVELS 4
+#define UPDATE_LOD_BUCKETS ((1 << UPDATE_LOD_MAX_LEVELS) - 1)
+// Frames between rebuilds for level changes alone.
+#define UPDATE_LOD_REBUILD_FRAMES 16
+
+typedef struct {
+    TransformComponentArray* transforms;
+    Vec3 focus;
+    int levelCount;           // 1..UPDATE_LOD_MAX_LEVELS.
+    float distances[UPDATE_LOD_MAX_LEVELS - 1];  // Level L + 1 starts beyond distances[L].
+
+    uint64_t frame;
+    double time;              // Sum of every frame's dt.
+
+    // Per entity.
+    uint8_t level[MAX_ENTITIES];
+    double lastTick[MAX_ENTITIES];     // time of the entity's previous tick.
+    float dt[MAX_ENTITIES];            // Valid for entities due this frame.
+    uint64_t dueFrame[MAX_ENTITIES];   // Frame the entity was last due.
+    uint32_t memberEpoch[MAX_ENTITIES];  // Rebuild an entity was last bucketed in.
+    uint32_t epoch;
+
+    // Members grouped by bucket, and this frame's due entities.
+    Entity order[MAX_ENTITIES];
+    int bucketStart[UPDATE_LOD_BUCKETS + 1];
+    Entity due[MAX_ENTITIES];
+    int dueCount;
+    uint32_t builtVersion;
+    uint64_t builtFrame;
+    int levelChanges;         // Since the last rebuild.
+
+    // Stats.
+    uint64_t ticks;           // Entity ticks over all frames.
+    uint64_t memberFrames;    // List length summed over all frames.
+    uint32_t rebuilds;
+} UpdateLod;
+
+// Set up with four levels starting at distances 80, 120 and 160 from the origin.
+void UpdateLod_Init(UpdateLod* lod, TransformComponentArray* transforms);
+
+// Level for a position.
+int UpdateLod_LevelFor(const UpdateLod* lod, Vec3 position);
+
+// Advance one frame of dt over the entities and collect the due ones into lod->due,
+// each with its accumulated dt in lod->dt. version must change whenever the list does.
+void UpdateLod_BeginFrame(UpdateLod* lod, const Entity* entities, int count, uint32_t version, float dt);
+
+// Forget an entity that went away, so its ID starts afresh if it comes back before
+// the next rebuild.
+static inline void UpdateLod_Forget(UpdateLod* lod, Entity entity) {
+    lod->memberEpoch[entity] = 0;
+}
+
+// Whether an entity ticks this frame.
+static inline int UpdateLod_IsDue(const UpdateLod* lod, Entity entity) {
+    return lod->dueFrame[entity] == lod->frame;
+}
+
+#endif // UPDATE_LOD_H
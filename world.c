@@ -0,0 +1,315 @@
+#include "world.h"
+#include "TransformComponent.h"
+#include "gravity_component.h"
+#include "rigid_body_component.h"
+#include "parent_component.h"
+#include "debug_module.h"
+#include "math3d.h"
+#include "logger.h"
+#include <string.h>
+
+void WorldConfig_Default(WorldConfig* config) {
+    memset(config, 0, sizeof(*config));
+    config->seed = 1;
+    config->hasGround = 1;
+    config->groundHeight = -160.0f; // Just below the lowest spawn height.
+    config->gravity = Vec3_Make(0.0f, -9.8f, 0.0f);
+    config->loadModules = 1;
+}
+
+int World_Init(World* world, const WorldConfig* config) {
+    memset(world, 0, sizeof(*world));
+    size_t arenaBytes = config->arenaBytes ? config->arenaBytes : WORLD_DEFAULT_ARENA_BYTES;
+    size_t scratchBytes = config->scratchBytes ? config->scratchBytes : WORLD_DEFAULT_SCRATCH_BYTES;
+    if (Arena_Init(&world->arena, arenaBytes, config->arenaFlags) != 0) {
+        LOG_ERROR("World: failed to reserve %zu bytes\n", arenaBytes);
+        return -1;
+    }
+    Arena* arena = &world->arena;
+    if (Arena_InitFromParent(&world->frameScratch, arena, scratchBytes) != 0 ||
+        Arena_InitFromParent(&world->renderScratch, arena, scratchBytes) != 0) {
+        goto fail;
+    }
+    world->jobs = config->jobs;
+    world->gravity = config->gravity;
+    world->rngState = config->seed ? config->seed : 1;
+
+    // --- Managers ---
+    world->entityManager = ARENA_NEW(arena, EntityManager);
+    world->componentManager = ARENA_NEW(arena, ComponentManager);
+    world->systemManager = ARENA_NEW(arena, SystemManager);
+    world->entityColors = ARENA_NEW_ARRAY(arena, SDL_Color, MAX_ENTITIES);
+    world->parentLinks = ARENA_NEW(arena, ParentLinks);
+    if (!world->entityManager || !world->componentManager || !world->systemManager || !world->entityColors ||
+        !world->parentLinks) {
+        goto fail;
+    }
+    EntityManager_Init(world->entityManager);
+    for (int i = 0; i < MAX_COMPONENT_TYPES; i++) {
+        world->componentManager->componentArrays[i] = NULL;
+    }
+    world->systemManager->count = 0;
+    memset(world->entityColors, 0xFF, sizeof(SDL_Color) * MAX_ENTITIES);
+    if (SnapshotBuffer_Init(&world->snapshots, arena, MAX_ENTITIES) != 0) {
+        goto fail;
+    }
+
+    // --- Component arrays ---
+    world->transformArray = ARENA_NEW(arena, TransformComponentArray);
+    world->gravityArray = ARENA_NEW(arena, GravityComponentArray);
+    world->rigidBodyArray = ARENA_NEW(arena, RigidBodyComponentArray);
+    world->parentArray = ARENA_NEW(arena, ParentComponentArray);
+    if (!world->transformArray || !world->gravityArray || !world->rigidBodyArray || !world->parentArray) {
+        goto fail;
+    }
+    TransformComponentArray_Init(world->transformArray);
+    ComponentManager_RegisterComponent(world->componentManager, COMPONENT_TRANSFORM, (IComponentArray*)world->transformArray);
+    GravityComponentArray_Init(world->gravityArray);
+    ComponentManager_RegisterComponent(world->componentManager, COMPONENT_GRAVITY, (IComponentArray*)world->gravityArray);
+    RigidBodyComponentArray_Init(world->rigidBodyArray);
+    ComponentManager_RegisterComponent(world->componentManager, COMPONENT_RIGID_BODY, (IComponentArray*)world->rigidBodyArray);
+    ParentComponentArray_Init(world->parentArray);
+    ComponentManager_RegisterComponent(world->componentManager, COMPONENT_PARENT, (IComponentArray*)world->parentArray);
+
+    // --- Systems ---
+    world->physicsSystem = ARENA_NEW(arena, PhysicsSystem);
+    world->hierarchySystem = ARENA_NEW(arena, HierarchySystem);
+    world->render3dSystem = ARENA_NEW(arena, Render3DSystem);
+    if (!world->physicsSystem || !world->hierarchySystem || !world->render3dSystem) {
+        goto fail;
+    }
+    PhysicsSystem_Init(world->physicsSystem, world->componentManager, &world->frameScratch);
+    if (config->hasGround) {
+        PhysicsSystem_SetGround(world->physicsSystem, config->groundHeight);
+    }
+    ContactSolver_Init(&world->contactSolver, world->jobs);
+    PhysicsSystem_SetContactSolver(world->physicsSystem, &world->contactSolver);
+    SystemManager_AddSystem(world->systemManager, (ECS_System*)world->physicsSystem);
+    if (config->updateLod) {
+        world->updateLod = ARENA_NEW(arena, UpdateLod);
+        if (!world->updateLod) {
+            goto fail;
+        }
+        // Distances are measured from the renderer's viewpoint.
+        UpdateLod_Init(world->updateLod, world->transformArray);
+        world->updateLod->focus = Vec3_Make(0.0f, 0.0f, -5.0f);
+        PhysicsSystem_SetUpdateLod(world->physicsSystem, world->updateLod);
+    }
+
+    HierarchySystem_Init(world->hierarchySystem, world->componentManager, world->jobs);
+    SystemManager_AddSystem(world->systemManager, (ECS_System*)world->hierarchySystem);
+
+    Render3DSystem_Init(world->render3dSystem, world->componentManager, &world->renderScratch, world->entityColors);
+    SystemManager_AddSystem(world->systemManager, (ECS_System*)world->render3dSystem);
+
+    Coordinator_Init(&world->coordinator, world->entityManager, world->componentManager, world->systemManager);
+    world->coordinator.arena = arena;
+    world->coordinator.modules = &world->modules;
+    for (int tag = TAG_FIRST; tag < TAG_END; tag++) {
+        Coordinator_EnableTagBitset(&world->coordinator, (TagType)tag, &world->tagBitsets[TAG_INDEX(tag)]);
+    }
+    Coordinator_EnableParentLinks(&world->coordinator, world->parentLinks);
+    PhysicsSystem_SetStaticTags(world->physicsSystem, &world->tagBitsets[TAG_INDEX(TAG_STATIC)]);
+
+    // --- Spatial sort ---
+    // Physics bodies' arrays follow the Transform order; so do the systems that walk them.
+    if (config->spatialSortSwaps > 0) {
+        world->spatialSort = ARENA_NEW(arena, SpatialSort);
+        if (!world->spatialSort ||
+            SpatialSort_Init(world->spatialSort, arena, world->transformArray, config->spatialSortSwaps) != 0) {
+            goto fail;
+        }
+        SpatialSort_AddArray(world->spatialSort, &world->rigidBodyArray->base);
+        SpatialSort_AddArray(world->spatialSort, &world->gravityArray->base);
+        SpatialSort_AddArray(world->spatialSort, &world->parentArray->base);
+        SpatialSort_AddSystem(world->spatialSort, &world->physicsSystem->base);
+        SpatialSort_AddSystem(world->spatialSort, &world->hierarchySystem->base);
+        SpatialSort_AddSystem(world->spatialSort, &world->render3dSystem->base);
+    }
+    Telemetry_Init(&world->telemetry, &world->coordinator, 0, NULL, NULL);
+
+    // --- Modules ---
+    // Modules share 4 ms of each frame; amortized work stops once it is used up.
+    ModuleRegistry_Init(&world->modules);
+    ModuleScheduler_Init(&world->moduleScheduler, &world->modules, 4.0, 1.0);
+    if (config->loadModules) {
+        register_module(&world->coordinator);
+    }
+    return 0;
+
+fail:
+    LOG_ERROR("World: arena of %zu bytes is too small\n", arenaBytes);
+    World_Destroy(world);
+    return -1;
+}
+
+void World_Destroy(World* world) {
+    ContactSolver_Shutdown(&world->contactSolver);
+    // Everything else lives in the arena.
+    Arena_Destroy(&world->arena);
+    memset(world, 0, sizeof(*world));
+}
+
+uint32_t World_Random(World* world) {
+    uint32_t x = world->rngState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    world->rngState = x;
+    return x;
+}
+
+float World_RandomFloat(World* world) {
+    return (float)(World_Random(world) >> 8) / (float)(1u << 24);
+}
+
+void World_SpawnFallingBlocks(World* world, int count) {
+    Coordinator* coordinator = &world->coordinator;
+
+    // Create entities with wide random positions, random rotations, negative Y gravity
+    for (int i = 0; i < count; i++) {
+        Entity entity = Coordinator_CreateEntity(coordinator);
+
+        // Spread them out more in X and Y
+        float randPosX = World_RandomFloat(world) * 300.0f - 150.0f;
+        float randPosY = World_RandomFloat(world) * 300.0f - 150.0f;
+        float randPosZ = World_RandomFloat(world) * 100.0f + 50.0f;
+
+        // Random 3-axis rotation
+        float randRotX = World_RandomFloat(world) * 6.283185f;  // 0..2pi
+        float randRotY = World_RandomFloat(world) * 6.283185f;
+        float randRotZ = World_RandomFloat(world) * 6.283185f;
+
+        float scale = 5.0f;
+
+        Gravity g = { world->gravity };
+
+        // No initial velocity, unit mass
+        RigidBody rb = { {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, 1.0f };
+
+        // Transform has position, rotation, scale
+        Transform t = {
+            { randPosX, randPosY, randPosZ },
+            Quat_FromEuler(randRotX, randRotY, randRotZ),
+            { scale, scale, scale }
+        };
+
+        // Assign random color
+        SDL_Color* color = &world->entityColors[entity];
+        color->r = (Uint8)(World_Random(world) % 256);
+        color->g = (Uint8)(World_Random(world) % 256);
+        color->b = (Uint8)(World_Random(world) % 256);
+        color->a = 255;
+
+        Coordinator_AddGravity(coordinator, entity, g);
+        Coordinator_AddRigidBody(coordinator, entity, rb);
+        Coordinator_AddTransform(coordinator, entity, t);
+
+        // Every tenth block carries a small satellite cube attached to it.
+        if (i % 10 == 0) {
+            Entity satellite = Coordinator_CreateEntity(coordinator);
+            Parent p = {
+                entity,
+                { { 6.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.4f, 0.4f, 0.4f } }
+            };
+            world->entityColors[satellite] = *color;
+            Coordinator_AddParent(coordinator, satellite, p);
+            Coordinator_AddTransform(coordinator, satellite, t);
+        }
+    }
+}
+
+void World_Step(World* world, float dt) {
+    // Between steps: nothing is iterating the arrays or system lists.
+    if (world->spatialSort) {
+        SpatialSort_Step(world->spatialSort);
+    }
+
+    // Last frame's temporaries are no longer referenced.
+    Arena_Reset(&world->frameScratch);
+
+    PhysicsSystem_Update(world->physicsSystem, dt);
+
+    // Carry attached entities along with their parents.
+    HierarchySystem_Update(world->hierarchySystem, dt);
+
+    // Tick registered modules (such as the debug module) within their budgets.
+    ModuleScheduler_Tick(&world->moduleScheduler, dt);
+    world->frame++;
+    Telemetry_Frame(&world->telemetry);
+}
+
+void World_ApplyInput(World* world, const InputEvent* input) {
+    PhysicsSystem* physics = world->physicsSystem;
+    switch (input->type) {
+    case INPUT_KICK:
+        for (int i = 0; i < physics->base.count; i++) {
+            PhysicsSystem_ApplyImpulse(physics, physics->base.entities[i], input->value);
+        }
+        break;
+    case INPUT_IMPULSE:
+        if (input->entity < MAX_ENTITIES &&
+            world->rigidBodyArray->entityToIndexMap[input->entity] != -1) {
+            PhysicsSystem_ApplyImpulse(physics, input->entity, input->value);
+        }
+        break;
+    default:
+        LOG_WARN("World: unknown input type %d\n", (int)input->type);
+        break;
+    }
+}
+
+// FNV-1a over raw bytes.
+static uint32_t HashBytes(uint32_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+#define HASH_COMPONENT_ARRAY(hash, arr) \
+    do { \
+        (hash) = HashBytes((hash), &(arr)->size, sizeof((arr)->size)); \
+        (hash) = HashBytes((hash), (arr)->components, (arr)->size * sizeof((arr)->components[0])); \
+        (hash) = HashBytes((hash), (arr)->indexToEntityMap, (arr)->size * sizeof((arr)->indexToEntityMap[0])); \
+    } while (0)
+
+uint32_t World_Checksum(const World* world) {
+    uint32_t hash = 2166136261u;
+    HASH_COMPONENT_ARRAY(hash, world->transformArray);
+    HASH_COMPONENT_ARRAY(hash, world->gravityArray);
+    HASH_COMPONENT_ARRAY(hash, world->rigidBodyArray);
+    HASH_COMPONENT_ARRAY(hash, world->parentArray);
+    return hash;
+}
+
+void World_Render(World* world, const Render3DTarget* target) {
+    Arena_Reset(&world->renderScratch);
+    Render3DSystem_Draw(world->render3dSystem, target);
+}
+
+void World_PublishSnapshot(World* world) {
+    Render3DSystem* r3dSys = world->render3dSystem;
+    TransformSnapshot* snapshot = SnapshotBuffer_BeginWrite(&world->snapshots);
+    int count = r3dSys->base.count;
+    for (int i = 0; i < count; i++) {
+        Entity entity = r3dSys->base.entities[i];
+        snapshot->transforms[i] = *TransformComponentArray_GetData(world->transformArray, entity);
+        snapshot->colors[i] = world->entityColors[entity];
+    }
+    snapshot->count = count;
+    snapshot->frame = world->frame;
+    SnapshotBuffer_Publish(&world->snapshots);
+}
+
+uint64_t World_RenderSnapshot(World* world, const Render3DTarget* target) {
+    const TransformSnapshot* snapshot = SnapshotBuffer_Acquire(&world->snapshots);
+    if (!snapshot) {
+        return 0;
+    }
+    Arena_Reset(&world->renderScratch);
+    Render3DSystem_DrawTransforms(world->render3dSystem, snapshot->transforms, snapshot->colors,
+        snapshot->count, target);
+    return snapshot->frame;
+}
@@ -0,0 +1,140 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <SDL3/SDL.h>
+#include <stdint.h>
+#include "arena.h"
+#include "coordinator.h"
+#include "entity_manager.h"
+#include "ComponentManager.h"
+#include "system_manager.h"
+#include "physics_system.h"
+#include "hierarchy_system.h"
+#include "render3d_system.h"
+#include "telemetry.h"
+#include "spatial_sort.h"
+#include "contact_solver.h"
+#include "job_system.h"
+#include "module.h"
+#include "module_scheduler.h"
+#include "transform_snapshot.h"
+
+// All ECS storage lives in the world arena. Per-frame temporaries come from two
+// scratch arenas inside it, one reset by World_Step and one by the render calls, so
+// the simulation and the renderer can run on different threads. Most of the world is
+// arrays of MAX_ENTITIES entries, so the defaults scale with it (about 32 MB and 8 MB
+// at 10000).
+#define WORLD_DEFAULT_ARENA_BYTES ((size_t)MAX_ENTITIES * 3300u)
+#define WORLD_DEFAULT_SCRATCH_BYTES ((size_t)MAX_ENTITIES * 840u)
+
+// Parameters for a new world.
+typedef struct {
+    size_t arenaBytes;        // 0 uses WORLD_DEFAULT_ARENA_BYTES.
+    size_t scratchBytes;      // Per scratch arena; 0 uses WORLD_DEFAULT_SCRATCH_BYTES.
+    int arenaFlags;           // Arena_Init flags, e.g. ARENA_HUGE_PAGES.
+    JobSystem* jobs;          // Shared worker pool; may be NULL.
+    uint32_t seed;            // Seed for the world's random numbers.
+    int hasGround;
+    float groundHeight;
+    Vec3 gravity;             // Gravity given to spawned bodies.
+    int loadModules;          // Register the built-in modules (debug module).
+    int spatialSortSwaps;     // > 0: keep arrays in Morton order, this many swaps per step.
+    int updateLod;            // Tick physics bodies far from the camera less often.
+} WorldConfig;
+
+// External inputs. Everything that changes a world from outside goes through
+// World_ApplyInput, so a session can be recorded and replayed exactly.
+typedef enum {
+    INPUT_KICK,               // Add `value` to the velocity of every physics body.
+    INPUT_IMPULSE,            // Add `value` to the velocity of `entity`.
+    INPUT_TYPE_COUNT
+} InputType;
+
+typedef struct {
+    uint32_t frame;           // World frame the input is applied before.
+    uint8_t type;             // InputType.
+    Entity entity;
+    Vec3 value;
+} InputEvent;
+
+// One independent simulation: managers, systems, modules and render data. Nothing
+// here is shared between worlds, so different worlds can be stepped on different
+// threads at the same time.
+typedef struct World {
+    Arena arena;
+    Arena frameScratch;       // Simulation temporaries.
+    Arena renderScratch;      // Render temporaries.
+    JobSystem* jobs;
+
+    EntityManager* entityManager;
+    ComponentManager* componentManager;
+    SystemManager* systemManager;
+    Coordinator coordinator;
+
+    TransformComponentArray* transformArray;
+    GravityComponentArray* gravityArray;
+    RigidBodyComponentArray* rigidBodyArray;
+    ParentComponentArray* parentArray;
+
+    PhysicsSystem* physicsSystem;
+    HierarchySystem* hierarchySystem;
+    Render3DSystem* render3dSystem;
+    ContactSolver contactSolver;
+
+    ModuleRegistry modules;
+    ModuleScheduler moduleScheduler;
+    SpatialSort* spatialSort; // NULL unless WorldConfig.spatialSortSwaps is set.
+    UpdateLod* updateLod;     // NULL unless WorldConfig.updateLod is set.
+    Telemetry telemetry;      // Sampled at the end of every step; no sink by default.
+
+    TagBitset tagBitsets[TAG_COUNT];  // Every tag is mirrored into a bitset.
+    ParentLinks* parentLinks; // Child lists, so destroying a parent detaches its children.
+    SDL_Color* entityColors;  // MAX_ENTITIES entries, indexed by entity.
+    SnapshotBuffer snapshots; // Render snapshots handed from the simulation thread.
+    Vec3 gravity;
+    uint32_t rngState;
+    uint64_t frame;
+} World;
+
+// Fill in the defaults: ground at -160, downward gravity, built-in modules.
+void WorldConfig_Default(WorldConfig* config);
+
+// Create the world's storage and systems. Returns 0 on success.
+int World_Init(World* world, const WorldConfig* config);
+
+// Release everything the world owns.
+void World_Destroy(World* world);
+
+// Spawn the falling-blocks scene: count randomly placed cubes, every tenth carrying
+// a small attached satellite.
+void World_SpawnFallingBlocks(World* world, int count);
+
+// Advance the simulation by one frame: physics, hierarchy, then modules. With a fixed
+// dt and the same seed and inputs, every run produces the same state.
+void World_Step(World* world, float dt);
+
+// Apply an external input. Call between steps, from the thread that owns the world.
+void World_ApplyInput(World* world, const InputEvent* input);
+
+// Hash of every component array (dense data and entity order), for comparing runs.
+uint32_t World_Checksum(const World* world);
+
+// Draw the world's cubes straight from the component arrays. Not safe while a step
+// runs on another thread; use the snapshot calls for that.
+void World_Render(World* world, const Render3DTarget* target);
+
+// Copy the renderer's view of the current frame into the snapshot buffer and
+// publish it. Called on the simulation thread after World_Step.
+void World_PublishSnapshot(World* world);
+
+// Draw the newest published snapshot. Safe to call while World_Step runs on another
+// thread. Returns the frame drawn, or 0 if nothing has been published yet.
+uint64_t World_RenderSnapshot(World* world, const Render3DTarget* target);
+
+// The world's random number stream (xorshift32).
+uint32_t World_Random(World* world);
+
+// Uniform float in [0, 1].
+float World_RandomFloat(World* world);
+
+#endif // WORLD_H
@@ -0,0 +1,21 @@
+#include "world_batch.h"
+
+typedef struct {
+    World** worlds;
+    int frames;
+    float dt;
+} WorldBatchJob;
+
+static void RunWorlds(void* userData, int begin, int end) {
+    WorldBatchJob* job = (WorldBatchJob*)userData;
+    for (int i = begin; i < end; i++) {
+        for (int frame = 0; frame < job->frames; frame++) {
+            World_Step(job->worlds[i], job->dt);
+        }
+    }
+}
+
+void WorldBatch_Run(World** worlds, int count, int frames, float dt, JobSystem* jobs) {
+    WorldBatchJob job = { worlds, frames, dt };
+    JobSystem_ParallelFor(jobs, count, 1, RunWorlds, &job);
+}
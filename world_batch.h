@@ -0,0 +1,12 @@
+#ifndef WORLD_BATCH_H
+#define WORLD_BATCH_H
+
+#include "world.h"
+#include "job_system.h"
+
+// Step `count` worlds `frames` times each, spreading the worlds over the job pool
+// (one world per chunk). Systems inside a world then run on their worker's thread,
+// since the pool is already busy with the batch. jobs may be NULL to run serially.
+void WorldBatch_Run(World** worlds, int count, int frames, float dt, JobSystem* jobs);
+
+#endif // WORLD_BATCH_H
@@ -0,0 +1,446 @@
+#include "world_stream.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+typedef enum {
+    STREAM_SAVE,              // Write blob to the cell's file, then free it.
+    STREAM_LOAD,              // Read the cell's file into a new blob.
+} StreamRequestType;
+
+// Cell file: magic, version, record count, then the records as they are in memory.
+// Only meant to be read back by the same build on the same machine.
+static const char streamMagic[4] = { 'E', 'C', 'S', 'C' };
+#define STREAM_FILE_VERSION 1u
+
+void WorldStreamConfig_Default(WorldStreamConfig* config, const char* directory) {
+    config->directory = directory;
+    config->minX = -160.0f;
+    config->minZ = -160.0f;
+    config->cellSize = 40.0f;
+    config->cellsX = 8;
+    config->cellsZ = 8;
+    config->loadRadius = 100.0f;
+    config->unloadRadius = 140.0f;
+    config->insertBudget = 64;
+    config->unloadBudget = 2;
+}
+
+// The header and both arrays in one allocation, so either thread can free it.
+static StreamBlob* StreamBlob_Create(int cell, int count) {
+    size_t bytes = sizeof(StreamBlob) + (size_t)count * (sizeof(StreamRecord) + sizeof(Entity));
+    StreamBlob* blob = (StreamBlob*)malloc(bytes);
+    if (!blob) {
+        return NULL;
+    }
+    blob->cell = cell;
+    blob->count = count;
+    blob->inserted = 0;
+    blob->records = (StreamRecord*)(blob + 1);
+    blob->ids = (Entity*)(blob->records + count);
+    return blob;
+}
+
+static void CellPath(const WorldStream* stream, int cell, char* path, size_t size) {
+    snprintf(path, size, "%s/cell_%03d.bin", stream->config.directory, cell);
+}
+
+// --- Queues ---
+
+static int StreamQueue_Push(StreamQueue* queue, const StreamRequest* request) {
+    if (queue->count == STREAM_QUEUE_CAPACITY) {
+        return 0;
+    }
+    queue->items[(queue->head + queue->count) % STREAM_QUEUE_CAPACITY] = *request;
+    queue->count++;
+    return 1;
+}
+
+static int StreamQueue_Pop(StreamQueue* queue, StreamRequest* request) {
+    if (queue->count == 0) {
+        return 0;
+    }
+    *request = queue->items[queue->head];
+    queue->head = (queue->head + 1) % STREAM_QUEUE_CAPACITY;
+    queue->count--;
+    return 1;
+}
+
+// --- I/O thread ---
+
+static int WriteCell(const char* path, const StreamBlob* blob, long long* bytes) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        return -1;
+    }
+    uint32_t header[2] = { STREAM_FILE_VERSION, (uint32_t)blob->count };
+    int ok = fwrite(streamMagic, sizeof(streamMagic), 1, file) == 1 &&
+        fwrite(header, sizeof(header), 1, file) == 1 &&
+        (blob->count == 0 || fwrite(blob->records, sizeof(StreamRecord), (size_t)blob->count, file) == (size_t)blob->count);
+    if (fclose(file) != 0) {
+        ok = 0;
+    }
+    *bytes = (long long)(sizeof(streamMagic) + sizeof(header) + (size_t)blob->count * sizeof(StreamRecord));
+    return ok ? 0 : -1;
+}
+
+static StreamBlob* ReadCell(const char* path, int cell, long long* bytes) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    char magic[4];
+    uint32_t header[2];
+    StreamBlob* blob = NULL;
+    if (fread(magic, sizeof(magic), 1, file) == 1 && memcmp(magic, streamMagic, sizeof(magic)) == 0 &&
+        fread(header, sizeof(header), 1, file) == 1 && header[0] == STREAM_FILE_VERSION &&
+        header[1] <= MAX_ENTITIES) {
+        blob = StreamBlob_Create(cell, (int)header[1]);
+        if (blob && blob->count > 0 &&
+            fread(blob->records, sizeof(StreamRecord), (size_t)blob->count, file) != (size_t)blob->count) {
+            free(blob);
+            blob = NULL;
+        }
+    }
+    fclose(file);
+    if (blob) {
+        *bytes = (long long)(sizeof(magic) + sizeof(header) + (size_t)blob->count * sizeof(StreamRecord));
+    }
+    return blob;
+}
+
+static void ProcessRequest(WorldStream* stream, StreamRequest* request) {
+    char path[512];
+    CellPath(stream, request->cell, path, sizeof(path));
+    request->bytes = 0;
+    if (request->type == STREAM_SAVE) {
+        request->ok = WriteCell(path, request->blob, &request->bytes) == 0;
+        if (request->ok) {
+            free(request->blob);
+            request->blob = NULL;
+        }
+        // On failure the blob goes back so its entities can be inserted again.
+    }
+    else {
+        request->blob = ReadCell(path, request->cell, &request->bytes);
+        request->ok = request->blob != NULL;
+        if (request->ok) {
+            remove(path);
+        }
+    }
+}
+
+static int StreamThread(void* data) {
+    WorldStream* stream = (WorldStream*)data;
+    for (;;) {
+        SDL_WaitSemaphore(stream->wake);
+        StreamRequest request;
+        SDL_LockMutex(stream->mutex);
+        int have = StreamQueue_Pop(&stream->requests, &request);
+        SDL_UnlockMutex(stream->mutex);
+        if (!have) {
+            // Only WorldStream_Stop signals without a request.
+            if (SDL_GetAtomicInt(&stream->quit)) {
+                break;
+            }
+            continue;
+        }
+        ProcessRequest(stream, &request);
+        SDL_LockMutex(stream->mutex);
+        int pushed = StreamQueue_Push(&stream->completions, &request);
+        SDL_UnlockMutex(stream->mutex);
+        assert(pushed && "Stream completion queue full.");
+        (void)pushed;
+    }
+    return 0;
+}
+
+// --- Main thread ---
+
+int WorldStream_Start(WorldStream* stream, World* world, const WorldStreamConfig* config) {
+    memset(stream, 0, sizeof(*stream));
+    stream->world = world;
+    stream->config = *config;
+    if (config->cellsX < 1 || config->cellsZ < 1 || config->cellsX * config->cellsZ > STREAM_MAX_CELLS ||
+        config->cellSize <= 0.0f) {
+        LOG_ERROR("WorldStream: bad grid (%d x %d cells)\n", config->cellsX, config->cellsZ);
+        return -1;
+    }
+    if (config->insertBudget < 1) stream->config.insertBudget = 1;
+    if (config->unloadBudget < 1) stream->config.unloadBudget = 1;
+    for (int i = 0; i < STREAM_MAX_CELLS; i++) {
+        stream->cellState[i] = STREAM_CELL_RESIDENT;
+    }
+
+    stream->recordOf = (int*)malloc(sizeof(int) * MAX_ENTITIES);
+    stream->gatherList = (Entity*)malloc(sizeof(Entity) * MAX_ENTITIES);
+    stream->mutex = SDL_CreateMutex();
+    stream->wake = SDL_CreateSemaphore(0);
+    if (!stream->recordOf || !stream->gatherList || !stream->mutex || !stream->wake) {
+        LOG_ERROR("WorldStream: out of memory\n");
+        WorldStream_Stop(stream);
+        return -1;
+    }
+    for (int i = 0; i < MAX_ENTITIES; i++) {
+        stream->recordOf[i] = -1;
+    }
+    SDL_SetAtomicInt(&stream->quit, 0);
+    stream->thread = SDL_CreateThread(StreamThread, "WorldStream", stream);
+    if (!stream->thread) {
+        LOG_ERROR("WorldStream: failed to create the I/O thread\n");
+        WorldStream_Stop(stream);
+        return -1;
+    }
+    return 0;
+}
+
+static int CellOf(const WorldStream* stream, Vec3 position) {
+    const WorldStreamConfig* config = &stream->config;
+    int x = (int)floorf((position.x - config->minX) / config->cellSize);
+    int z = (int)floorf((position.z - config->minZ) / config->cellSize);
+    if (x < 0) x = 0;
+    if (x >= config->cellsX) x = config->cellsX - 1;
+    if (z < 0) z = 0;
+    if (z >= config->cellsZ) z = config->cellsZ - 1;
+    return z * config->cellsX + x;
+}
+
+// Callers keep inFlight below the queue capacity, so this always fits.
+static void Submit(WorldStream* stream, int type, int cell, StreamBlob* blob) {
+    StreamRequest request = { type, cell, 0, 0, blob };
+    SDL_LockMutex(stream->mutex);
+    int pushed = StreamQueue_Push(&stream->requests, &request);
+    SDL_UnlockMutex(stream->mutex);
+    assert(pushed && "Stream request queue full.");
+    (void)pushed;
+    stream->inFlight++;
+    SDL_SignalSemaphore(stream->wake);
+}
+
+// Copy a cell's entities into a blob and destroy them. Roots are the Transform
+// entities without a Parent whose position is in the cell; their descendants follow
+// in later records, so a record's parent always comes before it.
+static StreamBlob* CollectCell(WorldStream* stream, int cell) {
+    World* world = stream->world;
+    TransformComponentArray* transforms = world->transformArray;
+    ParentComponentArray* parents = world->parentArray;
+    int count = 0;
+
+    for (size_t i = 0; i < transforms->size; i++) {
+        Entity e = transforms->indexToEntityMap[i];
+        if (parents->entityToIndexMap[e] == -1 && CellOf(stream, transforms->components[i].position) == cell) {
+            stream->recordOf[e] = count;
+            stream->gatherList[count++] = e;
+        }
+    }
+    // Pull in children until a pass finds none; one pass per hierarchy level.
+    for (int added = count; added > 0;) {
+        added = 0;
+        for (size_t i = 0; i < parents->size; i++) {
+            Entity e = parents->indexToEntityMap[i];
+            if (stream->recordOf[e] == -1 && stream->recordOf[parents->components[i].parent] != -1) {
+                stream->recordOf[e] = count;
+                stream->gatherList[count++] = e;
+                added++;
+            }
+        }
+    }
+
+    StreamBlob* blob = StreamBlob_Create(cell, count);
+    if (!blob) {
+        LOG_ERROR("WorldStream: out of memory unloading cell %d\n", cell);
+        for (int i = 0; i < count; i++) {
+            stream->recordOf[stream->gatherList[i]] = -1;
+        }
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        Entity e = stream->gatherList[i];
+        StreamRecord* record = &blob->records[i];
+        memset(record, 0, sizeof(*record));
+        record->transform = *TransformComponentArray_GetData(transforms, e);
+        record->color = world->entityColors[e];
+        record->parent = -1;
+        if (world->rigidBodyArray->entityToIndexMap[e] != -1) {
+            record->rigidBody = *RigidBodyComponentArray_GetData(world->rigidBodyArray, e);
+            record->components |= STREAM_HAS_RIGID_BODY;
+        }
+        if (world->gravityArray->entityToIndexMap[e] != -1) {
+            record->gravity = *GravityComponentArray_GetData(world->gravityArray, e);
+            record->components |= STREAM_HAS_GRAVITY;
+        }
+        if (parents->entityToIndexMap[e] != -1) {
+            const Parent* parent = ParentComponentArray_GetData(parents, e);
+            record->local = parent->local;
+            record->parent = stream->recordOf[parent->parent];
+            record->components |= STREAM_HAS_PARENT;
+        }
+        record->tags = EntityManager_GetSignature(world->entityManager, e) >> TAG_FIRST;
+    }
+    for (int i = 0; i < count; i++) {
+        Entity e = stream->gatherList[i];
+        stream->recordOf[e] = -1;
+        Coordinator_DestroyEntity(&world->coordinator, e);
+    }
+    return blob;
+}
+
+// Insert up to budget records of a blob. Returns the number inserted.
+static int InsertRecords(WorldStream* stream, StreamBlob* blob, int budget) {
+    Coordinator* coordinator = &stream->world->coordinator;
+    int done = 0;
+    for (; blob->inserted < blob->count && done < budget; blob->inserted++, done++) {
+        const StreamRecord* record = &blob->records[blob->inserted];
+        Entity e = Coordinator_CreateEntity(coordinator);
+        blob->ids[blob->inserted] = e;
+        stream->world->entityColors[e] = record->color;
+        if (record->components & STREAM_HAS_GRAVITY) {
+            Coordinator_AddGravity(coordinator, e, record->gravity);
+        }
+        if (record->components & STREAM_HAS_RIGID_BODY) {
+            Coordinator_AddRigidBody(coordinator, e, record->rigidBody);
+        }
+        if (record->components & STREAM_HAS_PARENT) {
+            assert(record->parent >= 0 && record->parent < blob->inserted && "Parent record must come first.");
+            Parent parent = { blob->ids[record->parent], record->local };
+            Coordinator_AddParent(coordinator, e, parent);
+        }
+        Coordinator_AddTransform(coordinator, e, record->transform);
+        for (int tag = TAG_FIRST; tag < TAG_END; tag++) {
+            if (record->tags & (1u << (tag - TAG_FIRST))) {
+                Coordinator_AddTag(coordinator, e, (TagType)tag);
+            }
+        }
+    }
+    return done;
+}
+
+static void BeginInsert(WorldStream* stream, StreamBlob* blob) {
+    stream->cellState[blob->cell] = STREAM_CELL_INSERTING;
+    stream->inserting[stream->insertingCount++] = blob;
+}
+
+// Apply everything the I/O thread has finished.
+static void TakeCompletions(WorldStream* stream) {
+    StreamRequest done[STREAM_QUEUE_CAPACITY];
+    int count = 0;
+    SDL_LockMutex(stream->mutex);
+    while (StreamQueue_Pop(&stream->completions, &done[count])) {
+        count++;
+    }
+    SDL_UnlockMutex(stream->mutex);
+
+    for (int i = 0; i < count; i++) {
+        StreamRequest* request = &done[i];
+        stream->inFlight--;
+        if (request->type == STREAM_SAVE) {
+            if (request->ok) {
+                stream->cellState[request->cell] = STREAM_CELL_ON_DISK;
+                stream->cellsUnloaded++;
+                stream->bytesWritten += request->bytes;
+            }
+            else {
+                LOG_ERROR("WorldStream: failed to write cell %d; keeping it in memory\n", request->cell);
+                stream->pinned[request->cell] = 1;
+                BeginInsert(stream, request->blob);
+            }
+        }
+        else if (request->ok) {
+            stream->bytesRead += request->bytes;
+            BeginInsert(stream, request->blob);
+        }
+        else {
+            LOG_ERROR("WorldStream: failed to read cell %d; its entities are lost\n", request->cell);
+            stream->cellState[request->cell] = STREAM_CELL_RESIDENT;
+        }
+    }
+}
+
+// Insert up to budget entities, oldest cell first.
+static void InsertPending(WorldStream* stream, int budget) {
+    while (stream->insertingCount > 0 && budget > 0) {
+        StreamBlob* blob = stream->inserting[0];
+        budget -= InsertRecords(stream, blob, budget);
+        if (blob->inserted < blob->count) {
+            break;
+        }
+        stream->cellState[blob->cell] = STREAM_CELL_RESIDENT;
+        stream->cellsLoaded++;
+        free(blob);
+        stream->insertingCount--;
+        memmove(&stream->inserting[0], &stream->inserting[1], sizeof(StreamBlob*) * (size_t)stream->insertingCount);
+    }
+}
+
+void WorldStream_Update(WorldStream* stream, Vec3 focus) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    const WorldStreamConfig* config = &stream->config;
+
+    TakeCompletions(stream);
+    InsertPending(stream, config->insertBudget);
+
+    int unloads = 0;
+    int cellCount = config->cellsX * config->cellsZ;
+    for (int cell = 0; cell < cellCount && stream->inFlight < STREAM_QUEUE_CAPACITY; cell++) {
+        float cx = config->minX + ((float)(cell % config->cellsX) + 0.5f) * config->cellSize;
+        float cz = config->minZ + ((float)(cell / config->cellsX) + 0.5f) * config->cellSize;
+        float dx = cx - focus.x;
+        float dz = cz - focus.z;
+        float distance = sqrtf(dx * dx + dz * dz);
+
+        if (stream->cellState[cell] == STREAM_CELL_RESIDENT && distance > config->unloadRadius &&
+            !stream->pinned[cell] && unloads < config->unloadBudget) {
+            StreamBlob* blob = CollectCell(stream, cell);
+            if (blob) {
+                Submit(stream, STREAM_SAVE, cell, blob);
+                stream->cellState[cell] = STREAM_CELL_SAVING;
+                unloads++;
+            }
+        }
+        else if (stream->cellState[cell] == STREAM_CELL_ON_DISK && distance < config->loadRadius) {
+            Submit(stream, STREAM_LOAD, cell, NULL);
+            stream->cellState[cell] = STREAM_CELL_LOADING;
+        }
+    }
+
+    stream->lastUpdateMs = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    if (stream->lastUpdateMs > stream->worstUpdateMs) {
+        stream->worstUpdateMs = stream->lastUpdateMs;
+    }
+}
+
+int WorldStream_CountCells(const WorldStream* stream, StreamCellState state) {
+    int count = 0;
+    for (int cell = 0; cell < stream->config.cellsX * stream->config.cellsZ; cell++) {
+        count += stream->cellState[cell] == state;
+    }
+    return count;
+}
+
+void WorldStream_Stop(WorldStream* stream) {
+    if (stream->thread) {
+        // The thread drains the request queue before it sees quit.
+        SDL_SetAtomicInt(&stream->quit, 1);
+        SDL_SignalSemaphore(stream->wake);
+        SDL_WaitThread(stream->thread, NULL);
+        stream->thread = NULL;
+        // Cells that were on their way back in are inserted now rather than dropped.
+        TakeCompletions(stream);
+        InsertPending(stream, MAX_ENTITIES);
+    }
+    if (stream->wake) {
+        SDL_DestroySemaphore(stream->wake);
+        stream->wake = NULL;
+    }
+    if (stream->mutex) {
+        SDL_DestroyMutex(stream->mutex);
+        stream->mutex = NULL;
+    }
+    free(stream->recordOf);
+    stream->recordOf = NULL;
+    free(stream->gatherList);
+    stream->gatherList = NULL;
+}
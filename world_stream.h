@@ -0,0 +1,125 @@
+#ifndef WORLD_STREAM_H
+#define WORLD_STREAM_H
+
+#include <SDL3/SDL.h>
+#include <stdint.h>
+#include "world.h"
+
+// Streams a world's entities in and out by region. The ground plane (x, z) is split
+// into a grid of cells. Cells far from the focus point are unloaded: their entities
+// are copied out, destroyed, and written to a file by a background I/O thread. Cells
+// that come back into range are read by that thread, and the main thread inserts
+// their entities again a bounded number per update.
+//
+// Children go with their parents: a cell takes the root entities (no Parent) whose
+// position is inside it, plus everything attached below them.
+//
+// Only WorldStream_Update touches the world, so call it where inputs are applied:
+// between steps, never while a pipelined step is running.
+
+#define STREAM_MAX_CELLS 256
+#define STREAM_QUEUE_CAPACITY 64
+
+typedef enum {
+    STREAM_CELL_RESIDENT,     // Entities are in the world (possibly none).
+    STREAM_CELL_SAVING,       // Copied out and destroyed; the file is being written.
+    STREAM_CELL_ON_DISK,      // Only in its file.
+    STREAM_CELL_LOADING,      // The file is being read.
+    STREAM_CELL_INSERTING,    // Read; entities are being inserted over several updates.
+} StreamCellState;
+
+// One entity as stored in a cell file.
+typedef struct {
+    Transform transform;
+    RigidBody rigidBody;
+    Gravity gravity;
+    Transform local;          // Parent.local when it has a parent.
+    SDL_Color color;
+    uint32_t components;      // STREAM_HAS_* bits.
+    uint32_t tags;            // Tag bits of the signature.
+    int32_t parent;           // Record index of the parent (always earlier), or -1.
+} StreamRecord;
+
+#define STREAM_HAS_RIGID_BODY 0x1u
+#define STREAM_HAS_GRAVITY    0x2u
+#define STREAM_HAS_PARENT     0x4u
+
+// A cell's entities on their way to or from disk.
+typedef struct {
+    int cell;
+    int count;
+    int inserted;             // Records inserted so far.
+    StreamRecord* records;
+    Entity* ids;              // New entity per inserted record.
+} StreamBlob;
+
+typedef struct {
+    int type;                 // StreamRequestType (world_stream.c).
+    int cell;
+    int ok;                   // Completions: the I/O succeeded.
+    long long bytes;          // Completions: bytes written or read.
+    StreamBlob* blob;
+} StreamRequest;
+
+// Fixed ring of requests, guarded by the stream's mutex.
+typedef struct {
+    StreamRequest items[STREAM_QUEUE_CAPACITY];
+    int head;
+    int count;
+} StreamQueue;
+
+typedef struct {
+    const char* directory;    // Where cell files go; must exist.
+    float minX, minZ;         // Grid origin; positions outside are clamped to the edge cells.
+    float cellSize;
+    int cellsX, cellsZ;       // cellsX * cellsZ <= STREAM_MAX_CELLS.
+    float loadRadius;         // Cells whose centre comes this close are loaded...
+    float unloadRadius;       // ...and unloaded beyond this (keep it larger).
+    int insertBudget;         // Entities inserted per update.
+    int unloadBudget;         // Cells unloaded per update.
+} WorldStreamConfig;
+
+typedef struct {
+    World* world;
+    WorldStreamConfig config;
+    uint8_t cellState[STREAM_MAX_CELLS];
+    uint8_t pinned[STREAM_MAX_CELLS];          // Writing failed; the cell stays in memory.
+    StreamBlob* inserting[STREAM_MAX_CELLS];    // Cells being inserted, in arrival order.
+    int insertingCount;
+    int* recordOf;            // Record index per entity while collecting a cell, else -1.
+    Entity* gatherList;
+
+    SDL_Thread* thread;
+    SDL_Mutex* mutex;
+    SDL_Semaphore* wake;
+    SDL_AtomicInt quit;
+    StreamQueue requests;     // Main thread -> I/O thread.
+    StreamQueue completions;  // I/O thread -> main thread.
+    int inFlight;             // Requests not completed yet.
+
+    // Stats.
+    int cellsUnloaded;
+    int cellsLoaded;
+    long long bytesWritten;
+    long long bytesRead;
+    double worstUpdateMs;
+    double lastUpdateMs;
+} WorldStream;
+
+// Defaults for the falling-blocks world: 8 x 8 cells of 40 over [-160, 160].
+void WorldStreamConfig_Default(WorldStreamConfig* config, const char* directory);
+
+// Start the I/O thread. Every cell starts resident. Returns 0 on success.
+int WorldStream_Start(WorldStream* stream, World* world, const WorldStreamConfig* config);
+
+// Take finished I/O, insert up to insertBudget entities, then unload and request
+// cells based on their distance to the focus (only x and z are used).
+void WorldStream_Update(WorldStream* stream, Vec3 focus);
+
+// Number of cells in a state.
+int WorldStream_CountCells(const WorldStream* stream, StreamCellState state);
+
+// Wait for outstanding I/O and stop the thread. Cells still on disk stay there.
+void WorldStream_Stop(WorldStream* stream);
+
+#endif // WORLD_STREAM_H